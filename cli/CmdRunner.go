@@ -179,6 +179,8 @@ func (rt *CmdRunner) execute(cmd *Command, output io.Writer) {
 		rt.executeLsPartitions(cc)
 	} else if cmd.Add != nil {
 		rt.executeAddNode(cc, cmd.Add)
+	} else if cmd.Checkpoint != nil {
+		rt.executeCheckpoint(cc, cmd.Checkpoint)
 	} else if cmd.Del != nil {
 		rt.executeDelNode(cc, cmd.Del)
 	} else if cmd.Ping != nil {
@@ -195,6 +197,8 @@ func (rt *CmdRunner) execute(cmd *Command, output io.Writer) {
 		rt.executeCollectPings(cc, cc.Pings)
 	} else if cmd.Counters != nil {
 		rt.executeCounters(cc, cc.Counters)
+	} else if cmd.Perf != nil {
+		rt.executePerf(cc, cmd.Perf)
 	} else if cmd.Joins != nil {
 		rt.executeCollectJoins(cc, cc.Joins)
 	} else if cmd.Coaps != nil {
@@ -207,6 +211,8 @@ func (rt *CmdRunner) execute(cmd *Command, output io.Writer) {
 		rt.executeDebug(cc, cmd.Debug)
 	} else if cmd.Title != nil {
 		rt.executeTitle(cc, cmd.Title)
+	} else if cmd.Traffic != nil {
+		rt.executeTraffic(cc, cmd.Traffic)
 	} else if cmd.DemoLegend != nil {
 		rt.executeDemoLegend(cc, cmd.DemoLegend)
 	} else if cmd.Exit != nil {
@@ -313,7 +319,33 @@ func (rt *CmdRunner) executeAddNode(cc *CommandContext, cmd *AddCmd) {
 
 	cfg.Restore = cmd.Restore != nil
 
+	count := 1
+	if cmd.Count != nil {
+		count = cmd.Count.Val
+		if count < 1 {
+			cc.errorf("invalid node count: %d", count)
+			return
+		}
+		if cmd.Id != nil {
+			cc.errorf("can not combine count with an explicit node id")
+			return
+		}
+	}
+
 	rt.postAsyncWait(func(sim *simulation.Simulation) {
+		if count > 1 {
+			nodes, err := sim.AddNodes(cfg, count)
+			if err != nil {
+				cc.error(err)
+				return
+			}
+
+			for _, node := range nodes {
+				cc.outputf("%d\n", node.Id)
+			}
+			return
+		}
+
 		node, err := sim.AddNode(cfg)
 		if err != nil {
 			cc.error(err)
@@ -338,6 +370,16 @@ func (rt *CmdRunner) executeDelNode(cc *CommandContext, cmd *DelCmd) {
 	})
 }
 
+func (rt *CmdRunner) executeCheckpoint(cc *CommandContext, cmd *CheckpointCmd) {
+	rt.postAsyncWait(func(sim *simulation.Simulation) {
+		if cmd.Save != nil {
+			cc.error(sim.SaveCheckpoint(cmd.Name))
+		} else {
+			cc.error(sim.LoadCheckpoint(cmd.Name))
+		}
+	})
+}
+
 func (rt *CmdRunner) executeExit(cc *CommandContext, cmd *ExitCmd) {
 	if rt.enterNodeContext(InvalidNodeId) {
 		return
@@ -401,6 +443,79 @@ func (rt *CmdRunner) executePing(cc *CommandContext, cmd *PingCmd) {
 	})
 }
 
+func (rt *CmdRunner) executeTraffic(cc *CommandContext, cmd *TrafficCmd) {
+	simplelogger.Debugf("traffic %#v", cmd)
+	rt.postAsyncWait(func(sim *simulation.Simulation) {
+		d := sim.Dispatcher()
+
+		if cmd.Add != nil {
+			srcs := make([]NodeId, 0, len(cmd.Add.Srcs))
+			for _, id := range cmd.Add.Srcs {
+				src, _ := rt.getNode(sim, NodeSelector{Id: id})
+				if src == nil {
+					cc.errorf("src node %d not found", id)
+					return
+				}
+				srcs = append(srcs, src.Id)
+			}
+
+			var dstaddrs []string
+			for _, id := range cmd.Add.Dsts {
+				dst, _ := rt.getNode(sim, NodeSelector{Id: id})
+				if dst == nil {
+					cc.errorf("dst node %d not found", id)
+					return
+				}
+				addrs := rt.getAddrs(dst, cmd.Add.AddrType)
+				if len(addrs) <= 0 {
+					cc.errorf("dst node %d addr not found", id)
+					return
+				}
+				dstaddrs = append(dstaddrs, addrs[0])
+			}
+
+			datasize := 4
+			if cmd.Add.DataSize != nil {
+				datasize = cmd.Add.DataSize.Val
+			}
+
+			var duration uint64
+			if cmd.Add.Duration != nil {
+				duration = uint64(cmd.Add.Duration.Val * 1000000)
+			}
+
+			flowId, err := d.AddTrafficFlow(dispatcher.TrafficFlowConfig{
+				SrcNodes: srcs,
+				DstAddrs: dstaddrs,
+				Rate:     cmd.Add.Rate,
+				DataSize: datasize,
+				Duration: duration,
+			})
+			if err != nil {
+				cc.error(err)
+				return
+			}
+
+			cc.outputf("%d\n", flowId)
+		} else if cmd.Stop != nil {
+			if cmd.Stop.Id != nil {
+				cc.error(d.StopTrafficFlow(*cmd.Stop.Id))
+			} else {
+				d.StopAllTrafficFlows()
+			}
+		} else if cmd.Stats != nil {
+			for _, st := range d.TrafficFlowStatsAll() {
+				avgDelay := uint64(0)
+				if st.Replied > 0 {
+					avgDelay = st.SumDelay / st.Replied
+				}
+				cc.outputf("flow=%-4d active=%-5v sent=%-6d replied=%-6d lost=%-6d delay=%d/%d/%dus\n",
+					st.Id, st.Active, st.Sent, st.Replied, st.Lost, st.MinDelay, avgDelay, st.MaxDelay)
+			}
+		}
+	})
+}
+
 func (rt *CmdRunner) getNode(sim *simulation.Simulation, sel NodeSelector) (*simulation.Node, *dispatcher.Node) {
 	if sel.Id > 0 {
 		return sim.Nodes()[sel.Id], sim.Dispatcher().Nodes()[sel.Id]
@@ -451,6 +566,11 @@ func (rt *CmdRunner) executeDebug(cc *CommandContext, cmd *DebugCmd) {
 }
 
 func (rt *CmdRunner) executeNode(cc *CommandContext, cmd *NodeCmd) {
+	if len(cmd.More) > 0 {
+		rt.executeNodeMulti(cc, cmd)
+		return
+	}
+
 	contextNodeId := InvalidNodeId
 	rt.postAsyncWait(func(sim *simulation.Simulation) {
 		node, _ := rt.getNode(sim, cmd.Node)
@@ -482,6 +602,35 @@ func (rt *CmdRunner) executeNode(cc *CommandContext, cmd *NodeCmd) {
 	}
 }
 
+// executeNodeMulti runs one command on multiple nodes concurrently; each
+// output line is prefixed with the node id it belongs to.
+func (rt *CmdRunner) executeNodeMulti(cc *CommandContext, cmd *NodeCmd) {
+	if cmd.Command == nil {
+		cc.errorf("a command is required when multiple nodes are given")
+		return
+	}
+
+	nodeids := make([]NodeId, 0, 1+len(cmd.More))
+	nodeids = append(nodeids, cmd.Node.Id)
+	for _, sel := range cmd.More {
+		nodeids = append(nodeids, sel.Id)
+	}
+
+	rt.postAsyncWait(func(sim *simulation.Simulation) {
+		outputs, errs := sim.CommandOnNodes(nodeids, *cmd.Command, simulation.DefaultCommandTimeout)
+
+		for _, nodeid := range nodeids {
+			if err := errs[nodeid]; err != nil {
+				cc.outputf("%d: Error: %v\n", nodeid, err)
+				continue
+			}
+			for _, line := range outputs[nodeid] {
+				cc.outputf("%d: %s\n", nodeid, line)
+			}
+		}
+	})
+}
+
 func (rt *CmdRunner) executeDemoLegend(cc *CommandContext, cmd *DemoLegendCmd) {
 	rt.postAsyncWait(func(sim *simulation.Simulation) {
 		sim.ShowDemoLegend(cmd.X, cmd.Y, cmd.Title)
@@ -544,13 +693,11 @@ func (rt *CmdRunner) executeLsNodes(cc *CommandContext, cmd *NodesCmd) {
 }
 
 func (rt *CmdRunner) executeLsPartitions(cc *CommandContext) {
-	pars := map[uint32][]NodeId{}
+	var pars map[uint32][]NodeId
 
 	rt.postAsyncWait(func(sim *simulation.Simulation) {
-		for nodeid, dnode := range sim.Dispatcher().Nodes() {
-			parid := dnode.PartitionId
-			pars[parid] = append(pars[parid], nodeid)
-		}
+		// served from the dispatcher's incremental partition index
+		pars = sim.Dispatcher().Partitions()
 	})
 
 	for parid, nodeids := range pars {
@@ -617,6 +764,34 @@ func (rt *CmdRunner) executeCounters(cc *CommandContext, counters *CountersCmd)
 	})
 }
 
+func (rt *CmdRunner) executePerf(cc *CommandContext, perf *PerfCmd) {
+	rt.postAsyncWait(func(sim *simulation.Simulation) {
+		stats := sim.Dispatcher().GetPerfStats()
+
+		cc.outputf("%-40s %v\n", "EventsReceived", stats.EventsReceived)
+		cc.outputf("%-40s %.1f\n", "EventsPerSec", stats.EventsPerSec)
+		cc.outputf("%-40s %v\n", "RequestedSpeed", stats.RequestedSpeed)
+		cc.outputf("%-40s %.2f\n", "AchievedSpeed", stats.AchievedSpeed)
+		cc.outputf("%-40s %v\n", "EventChanDepth", stats.EventChanDepth)
+		cc.outputf("%-40s %v\n", "PcapChanDepth", stats.PcapChanDepth)
+		cc.outputf("%-40s %v\n", "SendQueueDepth", stats.SendQueueDepth)
+
+		phases := []struct {
+			name  string
+			stats dispatcher.PerfPhaseStats
+		}{
+			{"Recv", stats.Recv},
+			{"Process", stats.Process},
+			{"Send", stats.Send},
+		}
+		for _, phase := range phases {
+			cc.outputf("%-40s count=%d avg=%dus p50=%dus p90=%dus p99=%dus max=%dus\n",
+				phase.name, phase.stats.Count, phase.stats.AvgUs,
+				phase.stats.P50Us, phase.stats.P90Us, phase.stats.P99Us, phase.stats.MaxUs)
+		}
+	})
+}
+
 func (rt *CmdRunner) executeWeb(cc *CommandContext, webcmd *WebCmd) {
 	if err := web.OpenWeb(rt.ctx); err != nil {
 		cc.error(err)
@@ -759,6 +934,32 @@ func (rt *CmdRunner) executeCoaps(cc *CommandContext, cmd *CoapsCmd) {
 		rt.postAsyncWait(func(sim *simulation.Simulation) {
 			sim.Dispatcher().EnableCoaps()
 		})
+	} else if cmd.Log != nil {
+		rt.postAsyncWait(func(sim *simulation.Simulation) {
+			cc.error(sim.Dispatcher().SetCoapsLogFile(cmd.Log.File))
+		})
+	} else if cmd.Node != nil || cmd.Uri != nil || cmd.From != nil || cmd.To != nil {
+		// filtered queries return matching messages without draining them
+		filter := dispatcher.CoapMessageFilter{}
+		if cmd.Node != nil {
+			filter.SrcNode = cmd.Node.Val
+		}
+		if cmd.Uri != nil {
+			filter.URI = cmd.Uri.Val
+		}
+		if cmd.From != nil {
+			filter.MinTime = uint64(cmd.From.Val * 1000000)
+		}
+		if cmd.To != nil {
+			filter.MaxTime = uint64(cmd.To.Val * 1000000)
+		}
+
+		var coapMessages []*dispatcher.CoapMessage
+		rt.postAsyncWait(func(sim *simulation.Simulation) {
+			coapMessages = sim.Dispatcher().QueryCoapMessages(filter)
+		})
+
+		cc.outputItemsAsYaml(coapMessages)
 	} else {
 		var coapMessages []*dispatcher.CoapMessage
 		rt.postAsyncWait(func(sim *simulation.Simulation) {
@@ -37,6 +37,7 @@ import (
 //noinspection GoStructTag
 type Command struct {
 	Add                 *AddCmd                 `  @@` //nolint
+	Checkpoint          *CheckpointCmd          `| @@` //nolint
 	Coaps               *CoapsCmd               `| @@` //nolint
 	ConfigVisualization *ConfigVisualizationCmd `| @@` //nolint
 	CountDown           *CountDownCmd           `| @@` //nolint
@@ -52,6 +53,7 @@ type Command struct {
 	Node                *NodeCmd                `| @@` //nolint
 	Nodes               *NodesCmd               `| @@` //nolint
 	Partitions          *PartitionsCmd          `| @@` //nolint
+	Perf                *PerfCmd                `| @@` //nolint
 	Ping                *PingCmd                `| @@` //nolint
 	Pings               *PingsCmd               `| @@` //nolint
 	Plr                 *PlrCmd                 `| @@` //nolint
@@ -59,6 +61,7 @@ type Command struct {
 	Scan                *ScanCmd                `| @@` //nolint
 	Speed               *SpeedCmd               `| @@` //nolint
 	Title               *TitleCmd               `| @@` //nolint
+	Traffic             *TrafficCmd             `| @@` //nolint
 	Web                 *WebCmd                 `| @@` //nolint
 }
 
@@ -166,9 +169,10 @@ type NetInfoCmd struct {
 
 //noinspection GoStructTag
 type NodeCmd struct {
-	Cmd     struct{}     `"node"`      //nolint
-	Node    NodeSelector `@@`          //nolint
-	Command *string      `[ @String ]` //nolint
+	Cmd     struct{}       `"node"`      //nolint
+	Node    NodeSelector   `@@`          //nolint
+	More    []NodeSelector `( @@ )*`     //nolint
+	Command *string        `[ @String ]` //nolint
 }
 
 //noinspection GoStructTag
@@ -248,6 +252,41 @@ type TitleCmd struct {
 	FontSize *int     `| "fs" @Int )*`       //nolint
 }
 
+//noinspection GoStructTag
+type TrafficCmd struct {
+	Cmd   struct{}        `"traffic"` //nolint
+	Add   *TrafficAddCmd  `( @@`      //nolint
+	Stop  *TrafficStopCmd `| @@`      //nolint
+	Stats *StatsFlag      `| @@ )`    //nolint
+}
+
+//noinspection GoStructTag
+type TrafficAddCmd struct {
+	Cmd      struct{}      `"add"`                //nolint
+	Srcs     []int         `"src" ( @Int )+`      //nolint
+	Dsts     []int         `"dst" ( @Int )+`      //nolint
+	AddrType *AddrTypeFlag `[ @@ ]`               //nolint
+	Rate     float64       `"rate" (@Int|@Float)` //nolint
+	DataSize *DataSizeFlag `( @@`                 //nolint
+	Duration *DurationFlag `| @@ )*`              //nolint
+}
+
+//noinspection GoStructTag
+type TrafficStopCmd struct {
+	Cmd struct{} `"stop"`   //nolint
+	Id  *int     `[ @Int ]` //nolint
+}
+
+//noinspection GoStructTag
+type StatsFlag struct {
+	Dummy struct{} `"stats"` //nolint
+}
+
+//noinspection GoStructTag
+type DurationFlag struct {
+	Val float64 `("duration"|"dur") (@Int|@Float)` //nolint
+}
+
 //noinspection GoStructTag
 type AddCmd struct {
 	Cmd        struct{}        `"add"`                //nolint
@@ -255,6 +294,7 @@ type AddCmd struct {
 	X          *int            `( "x" (@Int|@Float) ` //nolint
 	Y          *int            `| "y" (@Int|@Float) ` //nolint
 	Id         *AddNodeId      `| @@`                 //nolint
+	Count      *CountFlag      `| @@`                 //nolint
 	RadioRange *RadioRangeFlag `| @@`                 //nolint
 	Restore    *RestoreFlag    `| @@`                 //nolint
 	Executable *ExecutableFlag `| @@ )*`              //nolint
@@ -291,10 +331,59 @@ type AddNodeId struct {
 	Val int `"id" @Int` //nolint
 }
 
+//noinspection GoStructTag
+type CheckpointCmd struct {
+	Cmd  struct{}  `"checkpoint"` //nolint
+	Save *SaveFlag `( @@`         //nolint
+	Load *LoadFlag `| @@ )`       //nolint
+	Name string    `@Ident`       //nolint
+}
+
+//noinspection GoStructTag
+type SaveFlag struct {
+	Dummy struct{} `"save"` //nolint
+}
+
+//noinspection GoStructTag
+type LoadFlag struct {
+	Dummy struct{} `"load"` //nolint
+}
+
 //noinspection GoStructTag
 type CoapsCmd struct {
-	Cmd    struct{}    `"coaps"` //nolint
-	Enable *EnableFlag `@@ ?`    //nolint
+	Cmd    struct{}       `"coaps"`     //nolint
+	Enable *EnableFlag    `[ @@`        //nolint
+	Log    *CoapsLogCmd   `| @@`        //nolint
+	Node   *CoapsNodeFlag `| ( @@`      //nolint
+	Uri    *CoapsUriFlag  `  | @@`      //nolint
+	From   *CoapsFromFlag `  | @@`      //nolint
+	To     *CoapsToFlag   `  | @@ )+ ]` //nolint
+}
+
+//noinspection GoStructTag
+type CoapsLogCmd struct {
+	Cmd  struct{} `"log"`   //nolint
+	File string   `@String` //nolint
+}
+
+//noinspection GoStructTag
+type CoapsNodeFlag struct {
+	Val int `"node" @Int` //nolint
+}
+
+//noinspection GoStructTag
+type CoapsUriFlag struct {
+	Val string `"uri" @String` //nolint
+}
+
+//noinspection GoStructTag
+type CoapsFromFlag struct {
+	Val float64 `"from" (@Int|@Float)` //nolint
+}
+
+//noinspection GoStructTag
+type CoapsToFlag struct {
+	Val float64 `"to" (@Int|@Float)` //nolint
 }
 
 type EnableFlag struct {
@@ -386,6 +475,11 @@ type PartitionsCmd struct {
 	Cmd struct{} `( "partitions" | "pts")` //nolint
 }
 
+//noinspection GoStructTag
+type PerfCmd struct {
+	Cmd struct{} `"perf"` //nolint
+}
+
 //noinspection GoStructTag
 type PingsCmd struct {
 	Cmd struct{} `"pings"` //nolint
@@ -0,0 +1,163 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package cli
+
+import (
+	"bufio"
+	"net"
+	"strings"
+
+	"github.com/openthread/ot-ns/progctx"
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+// CtrlServer serves the OTNS CLI over a TCP socket for automation clients
+// (e.g. the Python bindings). Unlike the interactive console, the protocol is
+// designed for pipelining: a client may write many request lines back to back
+// and read the correlated responses afterwards, so the per-command round-trip
+// latency is paid only once per batch.
+//
+// Each request line is "<id> <command>" with a client-chosen correlation id
+// token. Every response line of that command is prefixed with "<id> ", and the
+// response is terminated by "<id> Done" or "<id> Error: ...". Commands of one
+// connection are executed strictly in request order.
+type CtrlServer struct {
+	rt   *CmdRunner
+	ctx  *progctx.ProgCtx
+	addr string
+}
+
+func NewCtrlServer(ctx *progctx.ProgCtx, rt *CmdRunner, addr string) *CtrlServer {
+	return &CtrlServer{
+		rt:   rt,
+		ctx:  ctx,
+		addr: addr,
+	}
+}
+
+func (cs *CtrlServer) Run() error {
+	lis, err := net.Listen("tcp", cs.addr)
+	if err != nil {
+		return err
+	}
+	simplelogger.Infof("CLI control server serving on %s ...", lis.Addr())
+
+	cs.ctx.Defer(func() {
+		_ = lis.Close()
+	})
+
+	for {
+		conn, err := lis.Accept()
+		if err != nil {
+			return err
+		}
+
+		go cs.serveConn(conn)
+	}
+}
+
+func (cs *CtrlServer) serveConn(conn net.Conn) {
+	defer func() {
+		_ = conn.Close()
+	}()
+	simplelogger.Debugf("control connection from %v", conn.RemoteAddr())
+
+	scanner := bufio.NewScanner(conn)
+	scanner.Buffer(make([]byte, 4096), 1024*1024)
+	bw := bufio.NewWriter(conn)
+
+	for scanner.Scan() {
+		line := strings.TrimSpace(scanner.Text())
+		if len(line) == 0 {
+			continue
+		}
+
+		id := line
+		cmdline := ""
+		if sp := strings.IndexByte(line, ' '); sp >= 0 {
+			id = line[:sp]
+			cmdline = strings.TrimSpace(line[sp+1:])
+		}
+
+		w := &linePrefixWriter{w: bw, prefix: id + " "}
+		if len(cmdline) == 0 {
+			if _, err := bw.WriteString(id + " Error: empty command\n"); err != nil {
+				break
+			}
+		} else if err := cs.rt.HandleCommand(cmdline, w); err != nil {
+			break
+		}
+
+		// flush after every command so that clients pipelining only part of a
+		// batch still see the earlier responses
+		if err := bw.Flush(); err != nil {
+			break
+		}
+	}
+
+	simplelogger.Debugf("control connection from %v closed", conn.RemoteAddr())
+}
+
+// linePrefixWriter prefixes every line written through it, buffering partial
+// lines until their newline arrives.
+type linePrefixWriter struct {
+	w       *bufio.Writer
+	prefix  string
+	partial bool
+}
+
+func (pw *linePrefixWriter) Write(p []byte) (int, error) {
+	total := len(p)
+	for len(p) > 0 {
+		if !pw.partial {
+			if _, err := pw.w.WriteString(pw.prefix); err != nil {
+				return total - len(p), err
+			}
+			pw.partial = true
+		}
+
+		nl := -1
+		for i, b := range p {
+			if b == '\n' {
+				nl = i
+				break
+			}
+		}
+
+		n := len(p)
+		if nl >= 0 {
+			n = nl + 1
+			pw.partial = false
+		}
+
+		if _, err := pw.w.Write(p[:n]); err != nil {
+			return total - len(p), err
+		}
+		p = p[n:]
+	}
+	return total, nil
+}
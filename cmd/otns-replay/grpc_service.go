@@ -29,10 +29,17 @@ package main
 import (
 	"bufio"
 	"context"
+	"fmt"
+	"io"
+	"math"
 	"os"
+	"strconv"
+	"strings"
+	"sync"
 	"time"
 
 	pb "github.com/openthread/ot-ns/visualize/grpc/pb"
+	"github.com/openthread/ot-ns/visualize/grpc/replay"
 	"github.com/pkg/errors"
 	"github.com/simonlingoogle/go-simplelogger"
 	"google.golang.org/protobuf/encoding/prototext"
@@ -42,8 +49,63 @@ var (
 	unmarshalOptions = prototext.UnmarshalOptions{}
 )
 
+const noSeekPending = math.MaxUint64
+
+// replayCtrl carries the scrub state shared between the Command RPC and the
+// visualization streams: the playback speed and a pending seek target.
+type replayCtrl struct {
+	mu     sync.Mutex
+	speed  float64
+	seekTs uint64
+}
+
+func newReplayCtrl() *replayCtrl {
+	return &replayCtrl{
+		speed:  1,
+		seekTs: noSeekPending,
+	}
+}
+
+func (rc *replayCtrl) getSpeed() float64 {
+	rc.mu.Lock()
+	defer rc.mu.Unlock()
+	return rc.speed
+}
+
+func (rc *replayCtrl) setSpeed(speed float64) {
+	rc.mu.Lock()
+	defer rc.mu.Unlock()
+	rc.speed = speed
+}
+
+func (rc *replayCtrl) requestSeek(timestamp uint64) {
+	rc.mu.Lock()
+	defer rc.mu.Unlock()
+	rc.seekTs = timestamp
+}
+
+// seekPending reports whether a seek target is waiting to be taken.
+func (rc *replayCtrl) seekPending() bool {
+	rc.mu.Lock()
+	defer rc.mu.Unlock()
+	return rc.seekTs != noSeekPending
+}
+
+// takeSeek returns and clears the pending seek target, if any.
+func (rc *replayCtrl) takeSeek() (uint64, bool) {
+	rc.mu.Lock()
+	defer rc.mu.Unlock()
+	if rc.seekTs == noSeekPending {
+		return 0, false
+	}
+	ts := rc.seekTs
+	rc.seekTs = noSeekPending
+	return ts, true
+}
+
 type grpcService struct {
 	replayFile string
+	ctrl       *replayCtrl
 }
 
 func (gs *grpcService) Visualize(req *pb.VisualizeRequest, stream pb.VisualizeGrpcService_VisualizeServer) error {
@@ -74,9 +136,33 @@ waitloop:
 	return nil
 }
 
-func (gs *grpcService) Command(context.Context, *pb.CommandRequest) (*pb.CommandResponse, error) {
-	// TODO: implement some commands for replay (e.g. speed)
-	return nil, errors.Errorf("can not run command on replay")
+// Command implements the scrub API of the replay server:
+//
+//	seek <seconds>  - jump to the given simulation time; binary replays seek
+//	                  via the keyframe index instead of replaying from the start
+//	speed <factor>  - set the playback speed
+func (gs *grpcService) Command(_ context.Context, req *pb.CommandRequest) (*pb.CommandResponse, error) {
+	fields := strings.Fields(req.Command)
+	if len(fields) == 2 {
+		switch fields[0] {
+		case "seek":
+			seconds, err := strconv.ParseFloat(fields[1], 64)
+			if err != nil || seconds < 0 {
+				return nil, errors.Errorf("invalid seek time: %s", fields[1])
+			}
+			gs.ctrl.requestSeek(uint64(seconds * 1000000))
+			return &pb.CommandResponse{Output: []string{"Done"}}, nil
+		case "speed":
+			speed, err := strconv.ParseFloat(fields[1], 64)
+			if err != nil || speed <= 0 {
+				return nil, errors.Errorf("invalid speed: %s", fields[1])
+			}
+			gs.ctrl.setSpeed(speed)
+			return &pb.CommandResponse{Output: []string{fmt.Sprintf("speed %v", speed), "Done"}}, nil
+		}
+	}
+
+	return nil, errors.Errorf("unknown replay command: %s", req.Command)
 }
 
 func (gs *grpcService) visualizeStream(stream pb.VisualizeGrpcService_VisualizeServer, visualizeDone chan struct{}) {
@@ -89,10 +175,15 @@ func (gs *grpcService) visualizeStream(stream pb.VisualizeGrpcService_VisualizeS
 		}
 	}()
 
-	replay, err := os.Open(gs.replayFile)
+	if replay.IsBinaryReplay(gs.replayFile) {
+		gs.visualizeBinaryReplay(stream)
+		return
+	}
+
+	replayFd, err := os.Open(gs.replayFile)
 	simplelogger.PanicIfError(err)
 
-	scanner := bufio.NewScanner(bufio.NewReader(replay))
+	scanner := bufio.NewScanner(bufio.NewReader(replayFd))
 	scanner.Split(bufio.ScanLines)
 
 	startTime := time.Now()
@@ -113,3 +204,69 @@ func (gs *grpcService) visualizeStream(stream pb.VisualizeGrpcService_VisualizeS
 		simplelogger.PanicIfError(err)
 	}
 }
+
+// visualizeBinaryReplay streams a memory-mapped binary replay, honoring the
+// speed and seek requests of the scrub API. Seeking positions the reader at
+// the last keyframe at or before the target, so only the snapshot and the
+// short tail up to the target are streamed rather than the whole prefix.
+func (gs *grpcService) visualizeBinaryReplay(stream pb.VisualizeGrpcService_VisualizeServer) {
+	reader, err := replay.NewReader(gs.replayFile)
+	simplelogger.PanicIfError(err)
+	defer reader.Close()
+
+	// playback is anchored at (baseSim, baseReal); entry n plays at
+	// baseReal + (ts_n - baseSim) / speed
+	baseReal := time.Now()
+	baseSim := uint64(0)
+	speed := gs.ctrl.getSpeed()
+
+	for stream.Context().Err() == nil {
+		if ts, ok := gs.ctrl.takeSeek(); ok {
+			simplelogger.PanicIfError(reader.SeekTimestamp(ts))
+			baseSim = ts
+			baseReal = time.Now()
+		}
+
+		entry, err := reader.ReadEntry()
+		if err == io.EOF {
+			// stay around so that a seek can rewind the stream
+			time.Sleep(100 * time.Millisecond)
+			continue
+		}
+		simplelogger.PanicIfError(err)
+
+		// entries at or before the seek target re-establish state and are
+		// sent without pacing
+		if entry.Timestamp > baseSim {
+			for stream.Context().Err() == nil && !gs.ctrl.seekPending() {
+				if curSpeed := gs.ctrl.getSpeed(); curSpeed != speed {
+					// re-anchor at the current playback position so the new
+					// speed applies from here on
+					now := time.Now()
+					baseSim += uint64(float64(now.Sub(baseReal).Microseconds()) * speed)
+					baseReal = now
+					speed = curSpeed
+				}
+
+				playTime := baseReal.Add(time.Duration(float64(entry.Timestamp-baseSim) / speed * float64(time.Microsecond)))
+				wait := time.Until(playTime)
+				if wait <= 0 {
+					break
+				}
+				if wait > 200*time.Millisecond {
+					wait = 200 * time.Millisecond
+				}
+				time.Sleep(wait)
+			}
+
+			if gs.ctrl.seekPending() {
+				// the entry is superseded: the seek target's keyframe
+				// re-establishes all state
+				continue
+			}
+		}
+
+		err = stream.Send(entry.Event)
+		simplelogger.PanicIfError(err)
+	}
+}
@@ -63,7 +63,7 @@ func main() {
 	ctx := progctx.New(context.Background())
 
 	server := grpc.NewServer(grpc.ReadBufferSize(1024*8), grpc.WriteBufferSize(1024*1024*1))
-	gs := &grpcService{replayFile: args.ReplayFile}
+	gs := &grpcService{replayFile: args.ReplayFile, ctrl: newReplayCtrl()}
 	pb.RegisterVisualizeGrpcServiceServer(server, gs)
 
 	lis, err := net.Listen("tcp", ":8999")
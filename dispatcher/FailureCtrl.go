@@ -46,10 +46,9 @@ var (
 )
 
 type FailureCtrl struct {
-	owner            *Node
-	failTime         FailTime
-	recoverTs        uint64
-	elapsedTimeAccum uint64
+	owner     *Node
+	failTime  FailTime
+	recoverTs uint64
 }
 
 func newFailureCtrl(owner *Node, failTime FailTime) *FailureCtrl {
@@ -61,49 +60,59 @@ func newFailureCtrl(owner *Node, failTime FailTime) *FailureCtrl {
 
 func (fc *FailureCtrl) SetFailTime(failTime FailTime) {
 	fc.failTime = failTime
-	if !failTime.CanFail() && fc.owner.IsFailed() {
-		fc.recoverTs = 0
-		fc.owner.Recover()
-	}
-}
 
-func (fc *FailureCtrl) OnTimeAdvanced(oldTime uint64) {
-	if !fc.failTime.CanFail() {
+	if !failTime.CanFail() {
+		fc.owner.D.scheduler.SetFailureTimestamp(fc.owner.Id, Ever)
+		if fc.owner.IsFailed() {
+			fc.recoverTs = 0
+			fc.owner.Recover()
+		}
 		return
 	}
 
 	if fc.owner.IsFailed() {
-		simplelogger.AssertTrue(fc.recoverTs > 0 && fc.elapsedTimeAccum == 0)
-		fc.tryRecoverNode()
+		if fc.recoverTs == 0 {
+			// the node was failed explicitly; schedule its recovery
+			fc.recoverTs = fc.owner.D.CurTime + failTime.FailDuration
+			fc.owner.D.scheduler.SetFailureTimestamp(fc.owner.Id, fc.recoverTs)
+		}
 		return
 	}
 
-	simplelogger.AssertTrue(fc.recoverTs == 0)
+	fc.scheduleNextFail()
+}
 
-	periodTime := fc.failTime.FailInterval
-	fc.elapsedTimeAccum += fc.owner.CurTime - oldTime
-	for !fc.owner.IsFailed() && fc.elapsedTimeAccum >= periodTime/100 {
-		fc.elapsedTimeAccum -= periodTime / 100
-		if rand.Float32() < 0.01 {
-			// make the node fail
-			fc.failNode()
-		}
+// scheduleNextFail draws the delay until the node's next failure from an
+// exponential distribution with mean FailInterval. This matches the expected
+// failure rate of the former per-advance sampling, but the transition time is
+// fixed when it is drawn, so it no longer depends on how node time happens to
+// advance.
+func (fc *FailureCtrl) scheduleNextFail() {
+	delay := uint64(rand.ExpFloat64() * float64(fc.failTime.FailInterval))
+	if delay == 0 {
+		delay = 1
 	}
+	fc.owner.D.scheduler.SetFailureTimestamp(fc.owner.Id, fc.owner.D.CurTime+delay)
 }
 
-func (fc *FailureCtrl) tryRecoverNode() {
-	simplelogger.AssertTrue(fc.owner.IsFailed())
-	if fc.owner.CurTime >= fc.recoverTs {
+// onTimedEvent handles the node's due failure-control transition: it fails a
+// working node and schedules its recovery, or recovers a failed node and
+// schedules its next failure.
+func (fc *FailureCtrl) onTimedEvent(timestamp uint64) {
+	if !fc.failTime.CanFail() {
+		// the failure time was cleared after the event was scheduled
+		return
+	}
+
+	if fc.owner.IsFailed() {
+		simplelogger.AssertTrue(fc.recoverTs > 0)
 		fc.recoverTs = 0
 		fc.owner.Recover()
+		fc.scheduleNextFail()
+	} else {
+		simplelogger.AssertTrue(fc.recoverTs == 0)
+		fc.recoverTs = timestamp + fc.failTime.FailDuration
+		fc.owner.Fail()
+		fc.owner.D.scheduler.SetFailureTimestamp(fc.owner.Id, fc.recoverTs)
 	}
 }
-
-func (fc *FailureCtrl) failNode() {
-	simplelogger.AssertTrue(!fc.owner.IsFailed())
-
-	fc.recoverTs = fc.owner.CurTime + fc.failTime.FailDuration
-	fc.elapsedTimeAccum = 0
-
-	fc.owner.Fail()
-}
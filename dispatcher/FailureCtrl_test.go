@@ -33,15 +33,32 @@ import (
 )
 
 func TestFailureCtrl(t *testing.T) {
+	d := &Dispatcher{scheduler: newEventScheduler()}
 	node1 := &Node{
+		D:  d,
 		Id: 0x1,
 	}
+	d.scheduler.AddNode(node1.Id)
 	node1.failureCtrl = newFailureCtrl(node1, NonFailTime)
 
-	for i := 0; i < 1000; i++ {
-		oldTime := node1.CurTime
-		node1.CurTime += 1000000
-		node1.failureCtrl.OnTimeAdvanced(oldTime)
-		assert.False(t, node1.IsFailed())
-	}
+	// without a failure time configured, no transition is ever scheduled
+	assert.Nil(t, d.scheduler.failures[node1.Id])
+	assert.Equal(t, Ever, d.scheduler.NextTimestamp())
+	assert.False(t, node1.IsFailed())
+
+	// configuring a failure time schedules the next failure as a timed event
+	node1.SetFailTime(FailTime{FailDuration: 60000000, FailInterval: 300000000})
+	fe := d.scheduler.failures[node1.Id]
+	assert.NotNil(t, fe)
+	assert.True(t, fe.Timestamp != Ever)
+	assert.Equal(t, fe.Timestamp, d.scheduler.NextTimestamp())
+
+	it := d.scheduler.PopNext()
+	assert.True(t, it.Fail)
+	assert.Equal(t, node1.Id, it.NodeId)
+	assert.Equal(t, Ever, d.scheduler.NextTimestamp())
+
+	// clearing the failure time cancels any pending transition
+	node1.SetFailTime(NonFailTime)
+	assert.Equal(t, Ever, fe.Timestamp)
 }
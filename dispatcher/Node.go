@@ -40,6 +40,10 @@ import (
 const (
 	maxPingResultCount = 1000
 	maxJoinResultCount = 1000
+
+	// maxPingDelayUs is the delay after which a pending ping request is
+	// considered lost; lost pings are recorded with this delay value.
+	maxPingDelayUs uint64 = 10 * 1000000
 )
 
 type pingRequest struct {
@@ -75,10 +79,19 @@ type Node struct {
 	CurTime     uint64
 	Role        OtDeviceRole
 
-	peerAddr      *net.UDPAddr
-	failureCtrl   *FailureCtrl
-	isFailed      bool
-	radioRange    int
+	peerAddr    net.Addr
+	failureCtrl *FailureCtrl
+	isFailed    bool
+	radioRange  int
+	// channel is the 802.15.4 channel the node listens on, 0 while unknown;
+	// nodes with an unknown channel receive frames on any channel
+	channel uint8
+	// cached list of nodes within radioRange, valid while neighborCacheGen
+	// matches the spatial index generation
+	neighborCache    []*Node
+	neighborCacheGen uint64
+	// buffered outgoing events, flushed as one datagram (see SendMessage)
+	sendBuf       []byte
 	pendingPings  []*pingRequest
 	pingResults   []*PingResult
 	joinerState   OtJoinerState
@@ -125,13 +138,47 @@ func (node *Node) Send(elapsed uint64, data []byte) {
 }
 
 func (node *Node) SendMessage(msg []byte) {
+	if node.D.cfg.CoalesceEvents {
+		node.bufferMessage(msg)
+		return
+	}
+
+	node.sendMessageNow(msg)
+}
+
+func (node *Node) sendMessageNow(msg []byte) {
 	if node.peerAddr != nil {
-		_, _ = node.D.udpln.WriteToUDP(msg, node.peerAddr)
+		_ = node.D.transport.WriteEvent(msg, node.peerAddr)
 	} else {
 		simplelogger.Errorf("%s does not have a peer address", node)
 	}
 }
 
+// bufferMessage appends msg to the node's send buffer. Events are
+// self-delimiting (the header carries the data length), so multiple buffered
+// events are simply concatenated into one datagram and unpacked in order by
+// the node.
+func (node *Node) bufferMessage(msg []byte) {
+	if len(node.sendBuf)+len(msg) > eventPayloadBufSize {
+		node.FlushSendBuffer()
+	}
+	if len(msg) >= eventPayloadBufSize {
+		node.sendMessageNow(msg)
+		return
+	}
+
+	node.sendBuf = append(node.sendBuf, msg...)
+	node.D.markSendDirty(node)
+}
+
+// FlushSendBuffer sends all buffered events of the node as one datagram.
+func (node *Node) FlushSendBuffer() {
+	if len(node.sendBuf) > 0 {
+		node.sendMessageNow(node.sendBuf)
+		node.sendBuf = node.sendBuf[:0]
+	}
+}
+
 func (node *Node) GetDistanceTo(other *Node) (dist int) {
 	dx := other.X - node.X
 	dy := other.Y - node.Y
@@ -161,7 +208,7 @@ func (node *Node) Recover() {
 
 func (node *Node) DumpStat() string {
 	d := node.D
-	alarmTs := d.alarmMgr.GetTimestamp(node.Id)
+	alarmTs := d.scheduler.GetTimestamp(node.Id)
 	return fmt.Sprintf("CurTime=%v, AlarmTs=%v, Failed=%-5v, RecoverTS=%v", node.CurTime, alarmTs, node.isFailed, node.failureCtrl.recoverTs)
 }
 
@@ -187,7 +234,6 @@ func (node *Node) onPingReply(timestamp uint64, dstaddr string, datasize int, ho
 		// if datasize < 4, timestamp is 0, these ping replies are ignored
 		return
 	}
-	const maxPingDelayUs uint64 = 10 * 1000000
 	var leftPingRequests []*pingRequest
 	for _, req := range node.pendingPings {
 		if req.Timestamp == timestamp && req.Dst == dstaddr {
@@ -214,6 +260,8 @@ func (node *Node) addPingResult(dst string, datasize int, delay uint64) {
 	if len(node.pingResults) > maxPingResultCount {
 		node.pingResults = node.pingResults[1:]
 	}
+
+	node.D.trafficGen.onPingResult(node.Id, dst, datasize, delay)
 }
 
 func (node *Node) CollectPings() []*PingResult {
@@ -0,0 +1,237 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"context"
+	"encoding/binary"
+	"fmt"
+	"net"
+	"sync/atomic"
+	"testing"
+	"time"
+
+	"github.com/openthread/ot-ns/progctx"
+	. "github.com/openthread/ot-ns/types"
+)
+
+// The benchmarks in this file drive a full Dispatcher with in-process
+// synthetic node stubs speaking the UDP event protocol, so dispatcher
+// throughput can be measured without building OpenThread or forking real
+// node processes. Each benchmark reports sim_us/s: simulated microseconds
+// advanced per real second.
+
+const (
+	benchAlarmPeriodUs = 10000
+	benchRadioRange    = 160
+)
+
+// each benchmark dispatcher gets its own port range
+var benchPortCounter int32 = 20000
+
+type benchCallbackHandler struct{}
+
+func (benchCallbackHandler) OnNodeFail(NodeId)          {}
+func (benchCallbackHandler) OnNodeRecover(NodeId)       {}
+func (benchCallbackHandler) OnUartWrite(NodeId, []byte) {}
+
+// benchNode is a synthetic node: it announces its extaddr, then sleeps in
+// benchAlarmPeriodUs steps and transmits frames on each wake according to the
+// configured traffic mix ("broadcast", "unicast" or "churn").
+type benchNode struct {
+	conn    *net.UDPConn
+	extaddr uint64
+	target  uint64
+	mix     string
+	seq     uint8
+	wakes   uint64
+	done    chan struct{}
+}
+
+func startBenchNode(b *testing.B, basePort int, id NodeId, extaddr, target uint64, mix string) *benchNode {
+	localAddr := &net.UDPAddr{IP: net.ParseIP("127.0.0.1"), Port: basePort + id}
+	remoteAddr := &net.UDPAddr{IP: net.ParseIP("127.0.0.1"), Port: basePort}
+	conn, err := net.DialUDP("udp", localAddr, remoteAddr)
+	if err != nil {
+		b.Fatal(err)
+	}
+
+	bn := &benchNode{
+		conn:    conn,
+		extaddr: extaddr,
+		target:  target,
+		mix:     mix,
+		done:    make(chan struct{}),
+	}
+	go bn.run()
+	return bn
+}
+
+func (bn *benchNode) run() {
+	defer close(bn.done)
+
+	bn.sendEvent(0, eventTypeStatusPush, []byte(fmt.Sprintf("extaddr=%016x", bn.extaddr)))
+	bn.sendEvent(benchAlarmPeriodUs, eventTypeAlarmFired, nil)
+
+	buf := make([]byte, 65536)
+	for {
+		n, err := bn.conn.Read(buf)
+		if err != nil {
+			return
+		}
+
+		// a datagram may carry several coalesced self-delimiting events
+		for off := 0; off+11 <= n; {
+			evtType := buf[off+8]
+			datalen := int(binary.LittleEndian.Uint16(buf[off+9 : off+11]))
+			off += 11 + datalen
+
+			if evtType == eventTypeAlarmFired {
+				bn.onWake()
+			}
+		}
+
+		// after processing any delivered events, declare the next wakeup
+		bn.sendEvent(benchAlarmPeriodUs, eventTypeAlarmFired, nil)
+	}
+}
+
+func (bn *benchNode) onWake() {
+	bn.wakes++
+
+	switch bn.mix {
+	case "broadcast":
+		bn.sendEvent(0, eventTypeRadioReceived, bn.broadcastFrame())
+	case "unicast":
+		bn.sendEvent(0, eventTypeRadioReceived, bn.unicastFrame())
+	case "churn":
+		if bn.wakes%16 == 0 {
+			// exercise the status push path as well
+			bn.sendEvent(0, eventTypeStatusPush, []byte(fmt.Sprintf("extaddr=%016x", bn.extaddr)))
+		} else if bn.wakes%2 == 0 {
+			bn.sendEvent(0, eventTypeRadioReceived, bn.broadcastFrame())
+		} else {
+			bn.sendEvent(0, eventTypeRadioReceived, bn.unicastFrame())
+		}
+	}
+}
+
+// broadcastFrame returns a data frame with the short broadcast destination.
+func (bn *benchNode) broadcastFrame() []byte {
+	bn.seq++
+	return []byte{11, 0x01, 0x08, bn.seq, 0xce, 0xfa, 0xff, 0xff}
+}
+
+// unicastFrame returns a data frame with the extended destination address of
+// the target node.
+func (bn *benchNode) unicastFrame() []byte {
+	bn.seq++
+	frame := []byte{11, 0x01, 0x0c, bn.seq, 0xce, 0xfa, 0, 0, 0, 0, 0, 0, 0, 0}
+	binary.LittleEndian.PutUint64(frame[6:], bn.target)
+	return frame
+}
+
+func (bn *benchNode) sendEvent(delay uint64, evtType uint8, data []byte) {
+	msg := make([]byte, 11+len(data))
+	binary.LittleEndian.PutUint64(msg[:8], delay)
+	msg[8] = evtType
+	binary.LittleEndian.PutUint16(msg[9:11], uint16(len(data)))
+	copy(msg[11:], data)
+	_, _ = bn.conn.Write(msg)
+}
+
+func (bn *benchNode) close() {
+	_ = bn.conn.Close()
+	<-bn.done
+}
+
+// benchGo advances the dispatcher like Run does for one go duration, but
+// directly on the benchmark goroutine.
+func benchGo(d *Dispatcher, duration time.Duration) {
+	d.speedStartRealTime = time.Now()
+	d.speedStartTime = d.CurTime
+
+	d.pauseTime += uint64(duration / time.Microsecond)
+	d.goUntilPauseTime()
+
+	d.syncAllNodes()
+	d.flushSendBuffers()
+}
+
+func benchmarkDispatcher(b *testing.B, numNodes int, mix string) {
+	basePort := int(atomic.AddInt32(&benchPortCounter, 1000))
+
+	ctx := progctx.New(context.Background())
+	cfg := DefaultConfig()
+	cfg.Host = "127.0.0.1"
+	cfg.Port = basePort
+	cfg.NoPcap = true
+	cfg.Speed = MaxSimulateSpeed
+
+	d := NewDispatcher(ctx, cfg, benchCallbackHandler{})
+	defer d.Stop()
+
+	// register all nodes first so no stub event arrives unexpected
+	nodeids := make([]NodeId, numNodes)
+	for i := 0; i < numNodes; i++ {
+		id := i + 1
+		nodeids[i] = id
+		d.AddNodeNoWait(id, (i%8)*100, (i/8)*100, benchRadioRange)
+	}
+
+	nodes := make([]*benchNode, numNodes)
+	for i := 0; i < numNodes; i++ {
+		id := i + 1
+		extaddr := uint64(0xbe570000) + uint64(id)
+		target := uint64(0xbe570000) + uint64(id%numNodes+1)
+		nodes[i] = startBenchNode(b, basePort, id, extaddr, target, mix)
+	}
+	defer func() {
+		for _, bn := range nodes {
+			bn.close()
+		}
+	}()
+
+	d.WaitNodesReady(nodeids)
+
+	b.ResetTimer()
+	t0 := time.Now()
+	for i := 0; i < b.N; i++ {
+		benchGo(d, time.Second)
+	}
+	elapsed := time.Since(t0)
+	b.StopTimer()
+
+	b.ReportMetric(float64(d.CurTime)/elapsed.Seconds(), "sim_us/s")
+}
+
+func BenchmarkDispatcherBroadcast16(b *testing.B) { benchmarkDispatcher(b, 16, "broadcast") }
+func BenchmarkDispatcherBroadcast64(b *testing.B) { benchmarkDispatcher(b, 64, "broadcast") }
+func BenchmarkDispatcherUnicast16(b *testing.B)   { benchmarkDispatcher(b, 16, "unicast") }
+func BenchmarkDispatcherUnicast64(b *testing.B)   { benchmarkDispatcher(b, 64, "unicast") }
+func BenchmarkDispatcherChurn16(b *testing.B)     { benchmarkDispatcher(b, 16, "churn") }
+func BenchmarkDispatcherChurn64(b *testing.B)     { benchmarkDispatcher(b, 64, "churn") }
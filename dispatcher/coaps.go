@@ -27,6 +27,10 @@
 package dispatcher
 
 import (
+	"os"
+
+	"gopkg.in/yaml.v3"
+
 	. "github.com/openthread/ot-ns/types"
 	"github.com/simonlingoogle/go-simplelogger"
 )
@@ -62,12 +66,67 @@ type CoapMessage struct {
 	Receivers []CoapMessageRecvInfo `yaml:"receivers,flow"`
 }
 
+// maxCoapMessages bounds the in-memory message store. When the ring is full,
+// the oldest message is evicted (and appended to the log file first when
+// streaming export is enabled).
+const maxCoapMessages = 10000
+
+// CoapMessageFilter selects messages by source node, URI and/or time range;
+// zero values match anything.
+type CoapMessageFilter struct {
+	SrcNode NodeId
+	URI     string
+	MinTime uint64
+	MaxTime uint64
+}
+
+func (f *CoapMessageFilter) match(msg *CoapMessage) bool {
+	if f.SrcNode != 0 && msg.SrcNode != f.SrcNode {
+		return false
+	}
+	if f.URI != "" && msg.URI != f.URI {
+		return false
+	}
+	if f.MinTime != 0 && msg.Timestamp < f.MinTime {
+		return false
+	}
+	if f.MaxTime != 0 && msg.Timestamp > f.MaxTime {
+		return false
+	}
+	return true
+}
+
+// coapsHandler keeps the observed CoAP messages in a bounded ring. It is only
+// touched from the dispatcher goroutine, so no locking is needed.
 type coapsHandler struct {
-	messages []*CoapMessage
+	ring  []*CoapMessage // oldest at head once the ring has wrapped
+	head  int
+	count int
+	// optional streaming export: evicted and drained messages are appended to
+	// this file as YAML list items
+	logFile *os.File
+}
+
+// push appends a message, evicting the oldest one when the ring is full.
+func (coaps *coapsHandler) push(msg *CoapMessage) {
+	if coaps.count == maxCoapMessages {
+		coaps.writeLog(coaps.ring[coaps.head])
+		coaps.ring[coaps.head] = msg
+		coaps.head = (coaps.head + 1) % maxCoapMessages
+		return
+	}
+
+	coaps.ring = append(coaps.ring, msg)
+	coaps.count++
+}
+
+// at returns the i-th message in arrival order, 0 being the oldest.
+func (coaps *coapsHandler) at(i int) *CoapMessage {
+	return coaps.ring[(coaps.head+i)%len(coaps.ring)]
 }
 
 func (coaps *coapsHandler) OnSend(curTime uint64, nodeId NodeId, messageId int, coapType CoapType, coapCode CoapCode, uri string, peerAddr string, peerPort int) {
-	coaps.messages = append(coaps.messages, &CoapMessage{
+	coaps.push(&CoapMessage{
 		Timestamp: curTime,
 		SrcNode:   nodeId,
 		ID:        messageId,
@@ -105,8 +164,8 @@ func (coaps *coapsHandler) OnSendError(nodeId NodeId, messageId int, coapType Co
 }
 
 func (coaps *coapsHandler) findMessage(id int, coapType CoapType, coapCode CoapCode, uri string) *CoapMessage {
-	for i := len(coaps.messages) - 1; i >= 0; i-- {
-		msg := coaps.messages[i]
+	for i := coaps.count - 1; i >= 0; i-- {
+		msg := coaps.at(i)
 		if msg.ID == id && msg.Type == coapType && msg.Code == coapCode && msg.URI == uri {
 			return msg
 		}
@@ -115,14 +174,71 @@ func (coaps *coapsHandler) findMessage(id int, coapType CoapType, coapCode CoapC
 	return nil
 }
 
-func (coaps *coapsHandler) DumpMessages() (ret []*CoapMessage) {
-	ret, coaps.messages = coaps.messages, nil
-	return
+// DumpMessages drains the ring in arrival order; drained messages are also
+// appended to the log file when streaming export is enabled.
+func (coaps *coapsHandler) DumpMessages() []*CoapMessage {
+	ret := make([]*CoapMessage, 0, coaps.count)
+	for i := 0; i < coaps.count; i++ {
+		msg := coaps.at(i)
+		coaps.writeLog(msg)
+		ret = append(ret, msg)
+	}
+
+	coaps.ring = nil
+	coaps.head = 0
+	coaps.count = 0
+	return ret
 }
 
-func newCoapsHandler() *coapsHandler {
-	coaps := &coapsHandler{
-		messages: nil,
+// QueryMessages returns the messages matching the filter in arrival order,
+// without draining them.
+func (coaps *coapsHandler) QueryMessages(filter CoapMessageFilter) []*CoapMessage {
+	var ret []*CoapMessage
+	for i := 0; i < coaps.count; i++ {
+		if msg := coaps.at(i); filter.match(msg) {
+			ret = append(ret, msg)
+		}
+	}
+	return ret
+}
+
+func (coaps *coapsHandler) setLogFile(filename string) error {
+	if err := coaps.closeLogFile(); err != nil {
+		return err
+	}
+
+	f, err := os.OpenFile(filename, os.O_CREATE|os.O_WRONLY|os.O_APPEND, 0644)
+	if err != nil {
+		return err
+	}
+	coaps.logFile = f
+	return nil
+}
+
+// writeLog appends one message to the log file as a YAML list item, so the
+// whole file stays one valid YAML list.
+func (coaps *coapsHandler) writeLog(msg *CoapMessage) {
+	if coaps.logFile == nil {
+		return
+	}
+
+	data, err := yaml.Marshal([]*CoapMessage{msg})
+	simplelogger.PanicIfError(err)
+	if _, err := coaps.logFile.Write(data); err != nil {
+		simplelogger.Errorf("write CoAP log failed: %v", err)
+	}
+}
+
+func (coaps *coapsHandler) closeLogFile() error {
+	if coaps.logFile == nil {
+		return nil
 	}
-	return coaps
+
+	err := coaps.logFile.Close()
+	coaps.logFile = nil
+	return err
+}
+
+func newCoapsHandler() *coapsHandler {
+	return &coapsHandler{}
 }
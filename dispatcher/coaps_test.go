@@ -0,0 +1,80 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+)
+
+func TestCoapsHandler_RingBounded(t *testing.T) {
+	coaps := newCoapsHandler()
+
+	total := maxCoapMessages + 5
+	for i := 0; i < total; i++ {
+		coaps.OnSend(uint64(i), 1, i, CoapTypeConfirmable, 2, "a", "addr", 1234)
+	}
+	assert.Equal(t, maxCoapMessages, coaps.count)
+
+	// the oldest messages were evicted; the rest is drained in arrival order
+	msgs := coaps.DumpMessages()
+	assert.Equal(t, maxCoapMessages, len(msgs))
+	assert.Equal(t, 5, msgs[0].ID)
+	assert.Equal(t, total-1, msgs[len(msgs)-1].ID)
+	assert.Equal(t, 0, coaps.count)
+}
+
+func TestCoapsHandler_FindMessageAfterWrap(t *testing.T) {
+	coaps := newCoapsHandler()
+
+	for i := 0; i < maxCoapMessages+10; i++ {
+		coaps.OnSend(uint64(i), 1, i, CoapTypeConfirmable, 2, "a", "addr", 1234)
+	}
+
+	// receives still find their (recent) send after the ring has wrapped
+	id := maxCoapMessages + 9
+	coaps.OnRecv(uint64(id), 2, id, CoapTypeConfirmable, 2, "a", "addr", 1234)
+	msg := coaps.findMessage(id, CoapTypeConfirmable, 2, "a")
+	assert.NotNil(t, msg)
+	assert.Equal(t, 1, len(msg.Receivers))
+}
+
+func TestCoapsHandler_QueryMessages(t *testing.T) {
+	coaps := newCoapsHandler()
+	coaps.OnSend(1000000, 1, 1, CoapTypeConfirmable, 2, "a", "addr", 1234)
+	coaps.OnSend(2000000, 2, 2, CoapTypeConfirmable, 2, "b", "addr", 1234)
+	coaps.OnSend(3000000, 1, 3, CoapTypeConfirmable, 2, "b", "addr", 1234)
+
+	assert.Equal(t, 2, len(coaps.QueryMessages(CoapMessageFilter{SrcNode: 1})))
+	assert.Equal(t, 2, len(coaps.QueryMessages(CoapMessageFilter{URI: "b"})))
+	assert.Equal(t, 1, len(coaps.QueryMessages(CoapMessageFilter{SrcNode: 1, URI: "b"})))
+	assert.Equal(t, 2, len(coaps.QueryMessages(CoapMessageFilter{MinTime: 1500000, MaxTime: 3000000})))
+
+	// queries do not drain the ring
+	assert.Equal(t, 3, coaps.count)
+}
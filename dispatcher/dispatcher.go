@@ -27,9 +27,10 @@
 package dispatcher
 
 import (
+	"bufio"
 	"encoding/binary"
 	"fmt"
-	"math/rand"
+	"io"
 	"os"
 	"strconv"
 	"strings"
@@ -37,7 +38,6 @@ import (
 
 	"github.com/openthread/ot-ns/progctx"
 
-	"github.com/openthread/ot-ns/dissectpkt"
 	"github.com/openthread/ot-ns/dissectpkt/wpan"
 	"github.com/openthread/ot-ns/pcap"
 	"github.com/openthread/ot-ns/threadconst"
@@ -62,7 +62,15 @@ const (
 
 type pcapFrameItem struct {
 	Ustime uint64
+	NodeId NodeId
 	Data   []byte
+	evt    *event // pooled event backing Data, recycled after the frame is written
+}
+
+type dumpFrameItem struct {
+	Ustime uint64
+	NodeId NodeId
+	Data   []byte // copied; does not alias the pooled event
 }
 
 type Config struct {
@@ -71,16 +79,44 @@ type Config struct {
 	Host        string
 	Port        int
 	DumpPackets bool
-	NoPcap      bool
+	// DumpPacketsFile, when non-empty, writes dumped frames as binary
+	// length-prefixed records (see dumpFrameWriter) to this file, or to a
+	// socket with a tcp:// or unix:// prefix, instead of hex lines on stdout.
+	DumpPacketsFile string
+	NoPcap          bool
+	// Parallel enables conservative parallel event execution of
+	// radio-connectivity islands (see parallel.go).
+	Parallel bool
+	// Transport selects how events are exchanged with nodes (see transport.go).
+	Transport string
+	// RadioModel selects how frame reachability is decided (see radiomodel.go).
+	RadioModel string
+	// CoalesceEvents packs all events destined for one node within a time step
+	// into a single datagram; requires a simulated platform that unpacks
+	// multiple events per datagram.
+	CoalesceEvents bool
+	// PcapFormat selects the capture file format (pcap.FormatPcap or
+	// pcap.FormatPcapng); PcapCompress additionally gzip-compresses it.
+	PcapFormat   string
+	PcapCompress bool
+	// PcapSync forces the capture to stable storage after every go period;
+	// when disabled, buffered frames are only flushed every PcapFlushInterval.
+	PcapSync          bool
+	PcapFlushInterval time.Duration
 }
 
 func DefaultConfig() *Config {
 	return &Config{
-		Speed:       1,
-		Real:        false,
-		Host:        "localhost",
-		Port:        threadconst.InitialDispatcherPort,
-		DumpPackets: false,
+		Speed:             1,
+		Real:              false,
+		Host:              "localhost",
+		Port:              threadconst.InitialDispatcherPort,
+		DumpPackets:       false,
+		Transport:         TransportTypeUdp,
+		RadioModel:        RadioModelDisc,
+		PcapFormat:        pcap.FormatPcap,
+		PcapSync:          true,
+		PcapFlushInterval: time.Second,
 	}
 }
 
@@ -98,32 +134,45 @@ type goDuration struct {
 }
 
 type Dispatcher struct {
-	ctx                   *progctx.ProgCtx
-	cfg                   Config
-	cbHandler             CallbackHandler
-	udpln                 *net.UDPConn
-	eventChan             chan *event
-	waitGroup             sync.WaitGroup
-	CurTime               uint64
-	pauseTime             uint64
-	alarmMgr              *alarmMgr
-	sendQueue             *sendQueue
-	nodes                 map[NodeId]*Node
-	deletedNodes          map[NodeId]struct{}
-	aliveNodes            map[NodeId]struct{}
-	pcap                  *pcap.File
-	pcapFrameChan         chan pcapFrameItem
-	vis                   visualize.Visualizer
-	taskChan              chan func()
-	speed                 float64
-	speedStartRealTime    time.Time
-	speedStartTime        uint64
-	extaddrMap            map[uint64]*Node
-	rloc16Map             rloc16Map
-	goDurationChan        chan goDuration
-	globalPacketLossRatio float64
-	visOptions            VisualizationOptions
-	coaps                 *coapsHandler
+	ctx                *progctx.ProgCtx
+	cfg                Config
+	cbHandler          CallbackHandler
+	transport          eventTransport
+	eventChan          chan *event
+	recvTimer          *time.Timer
+	pacer              *pacer
+	waitGroup          sync.WaitGroup
+	CurTime            uint64
+	pauseTime          uint64
+	scheduler          *eventScheduler
+	nodes              map[NodeId]*Node
+	spatialIndex       *spatialIndex
+	radioModel         radioModel
+	islands            *islandIndex
+	sendDirtyNodes     map[NodeId]*Node
+	deletedNodes       map[NodeId]struct{}
+	aliveNodes         map[NodeId]struct{}
+	pcap               *pcap.File
+	pcapFrameChan      chan pcapFrameItem
+	dumpSink           io.WriteCloser
+	dumpFrameChan      chan dumpFrameItem
+	vis                visualize.Visualizer
+	taskChan           chan func()
+	speed              float64
+	speedStartRealTime time.Time
+	speedStartTime     uint64
+	extaddrMap         map[uint64]*Node
+	rloc16Map          rloc16Map
+	// channelNodes indexes nodes by listening channel; bucket 0 holds nodes
+	// whose channel is not (yet) known
+	channelNodes   map[uint8]map[NodeId]*Node
+	goDurationChan chan goDuration
+	loss           *lossEngine
+	visOptions     VisualizationOptions
+	coaps          *coapsHandler
+	perf           *perfStats
+	trafficGen     *trafficGen
+	topology       *topologyIndex
 
 	Counters struct {
 		// Event counters
@@ -144,16 +193,11 @@ type Dispatcher struct {
 
 func NewDispatcher(ctx *progctx.ProgCtx, cfg *Config, cbHandler CallbackHandler) *Dispatcher {
 	simplelogger.AssertTrue(!cfg.Real || cfg.Speed == 1)
+	simplelogger.AssertTrue(!cfg.Real || !cfg.Parallel)
 
-	udpAddr, err := net.ResolveUDPAddr("udp4", fmt.Sprintf("%s:%d", cfg.Host, cfg.Port))
-	simplelogger.FatalIfError(err, err)
-	ln, err := net.ListenUDP("udp", udpAddr)
+	transport, err := newEventTransport(cfg)
 	simplelogger.FatalIfError(err, err)
-	_ = ln.SetWriteBuffer(25 * 1024 * 1024)
-	_ = ln.SetReadBuffer(25 * 1024 * 1024)
-	simplelogger.Infof("dispatcher listening on %s ...", udpAddr)
-
-	simplelogger.AssertNil(err)
+	simplelogger.Infof("dispatcher listening on %s ...", transport)
 
 	vis := visualize.NewNopVisualizer()
 
@@ -161,30 +205,49 @@ func NewDispatcher(ctx *progctx.ProgCtx, cfg *Config, cbHandler CallbackHandler)
 		ctx:                ctx,
 		cfg:                *cfg,
 		cbHandler:          cbHandler,
-		udpln:              ln,
+		transport:          transport,
 		eventChan:          make(chan *event, 10000),
-		alarmMgr:           newAlarmMgr(),
-		sendQueue:          newSendQueue(),
+		recvTimer:          time.NewTimer(time.Hour),
+		pacer:              newPacer(),
+		scheduler:          newEventScheduler(),
 		nodes:              make(map[NodeId]*Node),
+		spatialIndex:       newSpatialIndex(),
+		sendDirtyNodes:     make(map[NodeId]*Node),
 		deletedNodes:       map[NodeId]struct{}{},
 		aliveNodes:         make(map[NodeId]struct{}),
 		extaddrMap:         map[uint64]*Node{},
 		rloc16Map:          rloc16Map{},
+		channelNodes:       map[uint8]map[NodeId]*Node{},
 		pcapFrameChan:      make(chan pcapFrameItem, 100000),
 		speed:              cfg.Speed,
 		speedStartRealTime: time.Now(),
+		perf:               newPerfStats(),
+		loss:               newLossEngine(0),
 		vis:                vis,
 		taskChan:           make(chan func(), 100),
 		watchingNodes:      map[NodeId]struct{}{},
 		goDurationChan:     make(chan goDuration, 10),
 		visOptions:         defaultVisualizationOptions(),
 	}
+	d.trafficGen = newTrafficGen(d)
+	d.radioModel = newRadioModel(cfg.RadioModel, d)
+	d.topology = newTopologyIndex()
 	d.speed = d.normalizeSpeed(d.speed)
 	if !d.cfg.NoPcap {
-		d.pcap, err = pcap.NewFile("current.pcap")
+		pcapOptions := pcap.Options{
+			Format:   d.cfg.PcapFormat,
+			Compress: d.cfg.PcapCompress,
+		}
+		d.pcap, err = pcap.NewFile("current."+pcap.FileExtension(pcapOptions), pcapOptions)
 		simplelogger.PanicIfError(err)
 		go d.pcapFrameWriter()
 	}
+	if d.cfg.DumpPackets && d.cfg.DumpPacketsFile != "" {
+		d.dumpSink, err = openDumpSink(d.cfg.DumpPacketsFile)
+		simplelogger.PanicIfError(err)
+		d.dumpFrameChan = make(chan dumpFrameItem, 100000)
+		go d.dumpFrameWriter()
+	}
 
 	go d.eventsReader()
 
@@ -199,7 +262,16 @@ func (d *Dispatcher) Stop() {
 		return
 	}
 	d.stopped = true
+	_ = d.transport.Close()
+	if d.coaps != nil {
+		// flush messages not yet collected to the log file, if enabled
+		d.coaps.DumpMessages()
+		_ = d.coaps.closeLogFile()
+	}
 	close(d.pcapFrameChan)
+	if d.dumpFrameChan != nil {
+		close(d.dumpFrameChan)
+	}
 	d.vis.Stop()
 	d.waitGroup.Wait()
 }
@@ -261,7 +333,8 @@ loop:
 
 			simplelogger.AssertTrue(d.CurTime == d.pauseTime)
 			d.syncAllNodes()
-			if d.pcap != nil {
+			d.flushSendBuffers()
+			if d.pcap != nil && d.cfg.PcapSync {
 				_ = d.pcap.Sync()
 			}
 			close(duration.done)
@@ -284,7 +357,10 @@ func (d *Dispatcher) goUntilPauseTime() {
 		d.syncAliveNodes()
 
 		// process the next event
+		t0 := time.Now()
 		goon := d.processNextEvent()
+		d.perf.recordLoop(time.Since(t0), len(d.eventChan), len(d.pcapFrameChan), d.scheduler.SendQueueLen(),
+			d.speed, d.achievedSpeed())
 		simplelogger.AssertTrue(d.CurTime <= d.pauseTime)
 
 		if !goon && len(d.aliveNodes) == 0 {
@@ -293,7 +369,10 @@ func (d *Dispatcher) goUntilPauseTime() {
 	}
 }
 
-func (d *Dispatcher) handleRecvEvent(evt *event) {
+// handleRecvEvent processes one received event and reports whether it retained
+// the event (and its payload buffer) beyond this call; unretained pooled
+// events are recycled by the caller.
+func (d *Dispatcher) handleRecvEvent(evt *event) (retained bool) {
 	// create new node if necessary
 	nodeid := evt.NodeId
 	if _, ok := d.nodes[nodeid]; !ok {
@@ -302,7 +381,7 @@ func (d *Dispatcher) handleRecvEvent(evt *event) {
 			simplelogger.Warnf("unexpect event (type %v) received from Node %v", evt.Type, evt.NodeId)
 		}
 
-		return
+		return false
 	}
 
 	// assign source address from event to node
@@ -315,41 +394,85 @@ func (d *Dispatcher) handleRecvEvent(evt *event) {
 	}
 
 	delay := evt.Delay
+	// in parallel mode nodes may run ahead of the dispatcher clock, so event
+	// delays are anchored to the node's own time
+	evtBaseTime := d.CurTime
+	if d.cfg.Parallel {
+		evtBaseTime = node.CurTime
+	}
 	var evtTime uint64
 	if delay >= 2147483647 {
 		evtTime = Ever
 	} else {
-		evtTime = d.CurTime + evt.Delay
+		evtTime = evtBaseTime + evt.Delay
 	}
 
 	if d.cfg.Real && (evt.Type == eventTypeAlarmFired || evt.Type == eventTypeRadioReceived) {
 		// should not receive alarm event and radio event in real mode
 		simplelogger.Warnf("unexpected event in real mode: %v", evt.Type)
-		return
+		return false
 	}
 
 	switch evt.Type {
 	case eventTypeAlarmFired:
 		d.Counters.AlarmEvents += 1
 		d.setSleeping(nodeid)
-		d.alarmMgr.SetTimestamp(nodeid, evtTime)
+		d.scheduler.SetTimestamp(nodeid, evtTime)
 	case eventTypeRadioReceived:
 		d.Counters.RadioEvents += 1
-		d.sendQueue.Add(d.CurTime+1, nodeid, evt.Data)
+		// the send item takes over the pooled event; it is recycled after the
+		// frame is dispatched (and written to pcap)
+		d.scheduler.AddOwned(evtBaseTime+minPropagationDelayUs, nodeid, evt)
+		return true
 	case eventTypeStatusPush:
 		d.Counters.StatusPushEvents += 1
 		d.handleStatusPush(evt.NodeId, string(evt.Data))
+	case eventTypeStatusPushBinary:
+		d.Counters.StatusPushEvents += 1
+		d.handleStatusPushBinary(evt.NodeId, evt.Data)
 	case eventTypeUartWrite:
 		d.Counters.UartWriteEvents += 1
+		// the UART data may be retained by the callback handler
 		d.handleUartWrite(evt.NodeId, evt.Data)
+		return true
 	default:
 		simplelogger.Panicf("event type not implemented: %v", evt.Type)
 	}
+
+	return false
+}
+
+func (d *Dispatcher) markSendDirty(node *Node) {
+	d.sendDirtyNodes[node.Id] = node
+}
+
+// flushSendBuffers sends out all coalesced per-node event datagrams. This must
+// happen before waiting for node replies, since nodes only react to delivered
+// events.
+func (d *Dispatcher) flushSendBuffers() {
+	if len(d.sendDirtyNodes) == 0 {
+		return
+	}
+
+	for id, node := range d.sendDirtyNodes {
+		node.FlushSendBuffer()
+		delete(d.sendDirtyNodes, id)
+	}
 }
 
 // RecvEvents receives events from nodes until there is no more alive node.
 func (d *Dispatcher) RecvEvents() int {
-	blockTimeout := time.After(time.Second * 5)
+	t0 := time.Now()
+	d.flushSendBuffers()
+
+	// reuse one timer instead of allocating a new one per call
+	if !d.recvTimer.Stop() {
+		select {
+		case <-d.recvTimer.C:
+		default:
+		}
+	}
+	d.recvTimer.Reset(time.Second * 5)
 	count := 0
 
 loop:
@@ -360,8 +483,10 @@ loop:
 			select {
 			case evt := <-d.eventChan:
 				count += 1
-				d.handleRecvEvent(evt)
-			case <-blockTimeout:
+				if !d.handleRecvEvent(evt) {
+					putEvent(evt)
+				}
+			case <-d.recvTimer.C:
 				// timeout
 				break loop
 			}
@@ -369,27 +494,94 @@ loop:
 			select {
 			case evt := <-d.eventChan:
 				count += 1
-				d.handleRecvEvent(evt)
+				if !d.handleRecvEvent(evt) {
+					putEvent(evt)
+				}
 			default:
 				break loop
 			}
 		}
 	}
 
+	d.perf.recordRecv(count, time.Since(t0))
 	return count
 }
 
+const (
+	// minPaceSleep is the shortest sleep the pacer requests; below this the
+	// oversleep correction would have the dispatcher spin on the clock.
+	minPaceSleep = 50 * time.Microsecond
+	// realModeMaxSleep caps pacing sleeps in real mode so that the simulation
+	// clock keeps advancing for its observers even without node events.
+	realModeMaxSleep = 100 * time.Millisecond
+)
+
+// pacer sleeps the dispatcher until the next event's real-time deadline using
+// a single reusable timer instead of fixed 10 ms chunks. The requested sleep
+// is shortened by the measured timer oversleep so wakeups land close to the
+// deadline, and an arriving node event or task ends the sleep early so a far
+// event horizon does not add latency.
+type pacer struct {
+	timer     *time.Timer
+	oversleep time.Duration // smoothed measure of how late the timer fires
+}
+
+func newPacer() *pacer {
+	t := time.NewTimer(time.Hour)
+	if !t.Stop() {
+		<-t.C
+	}
+	return &pacer{timer: t}
+}
+
+func (p *pacer) sleep(d *Dispatcher, duration time.Duration) {
+	corrected := duration - p.oversleep
+	if corrected < minPaceSleep {
+		corrected = minPaceSleep
+		if corrected > duration {
+			corrected = duration
+		}
+	}
+
+	if !p.timer.Stop() {
+		select {
+		case <-p.timer.C:
+		default:
+		}
+	}
+	p.timer.Reset(corrected)
+
+	start := time.Now()
+	select {
+	case <-p.timer.C:
+		over := time.Since(start) - corrected
+		p.oversleep += (over - p.oversleep) / 8
+		if p.oversleep < 0 {
+			p.oversleep = 0
+		}
+	case evt := <-d.eventChan:
+		// a node event ends the sleep; the caller recomputes pacing
+		if !d.handleRecvEvent(evt) {
+			putEvent(evt)
+		}
+	case f := <-d.taskChan:
+		// recover like handleTasks so a failing task cannot kill the loop
+		func() {
+			defer func() {
+				if err := recover(); err != nil {
+					simplelogger.Errorf("dispatcher handle task failed: %+v", err)
+				}
+			}()
+			f()
+		}()
+	}
+}
+
 func (d *Dispatcher) processNextEvent() bool {
 	simplelogger.AssertTrue(d.CurTime <= d.pauseTime)
 
 	// we need to wait until all nodes are sleep
-	nextAlarmTime := d.alarmMgr.NextTimestamp()
-	nextSendtime := d.sendQueue.NextTimestamp()
-
-	nextEventTime := nextAlarmTime
-	if nextEventTime > nextSendtime {
-		nextEventTime = nextSendtime
-	}
+	nextEventTime := d.scheduler.NextTimestamp()
 
 	// nextEventTime <= d.pauseTime
 	// convert nextEventTime to real time
@@ -412,10 +604,10 @@ func (d *Dispatcher) processNextEvent() bool {
 		sleepTime := sleepUntilRealTime.Sub(now)
 
 		if sleepTime > 0 {
-			if sleepTime > time.Millisecond*10 {
-				sleepTime = time.Millisecond * 10
+			if d.cfg.Real && sleepTime > realModeMaxSleep {
+				sleepTime = realModeMaxSleep
 			}
-			time.Sleep(sleepTime)
+			d.pacer.sleep(d, sleepTime)
 
 			if d.cfg.Real {
 				curTime := d.speedStartTime + uint64(float64(time.Since(d.speedStartRealTime)/time.Microsecond)*d.speed)
@@ -433,66 +625,61 @@ func (d *Dispatcher) processNextEvent() bool {
 		return false
 	}
 
-	simplelogger.AssertTrue(nextAlarmTime >= d.CurTime && nextSendtime >= d.CurTime)
-	var procUntilTime uint64
-	if nextAlarmTime <= nextSendtime {
-		procUntilTime = nextAlarmTime + ProcessEventTimeErrorUs
-	} else {
-		procUntilTime = nextSendtime + ProcessEventTimeErrorUs
+	if d.cfg.Parallel && !d.cfg.Real {
+		d.processParallelBatch()
+		return len(d.nodes) > 0
 	}
 
+	simplelogger.AssertTrue(nextEventTime >= d.CurTime)
+	procUntilTime := nextEventTime + ProcessEventTimeErrorUs
 	if procUntilTime > d.pauseTime {
 		procUntilTime = d.pauseTime
 	}
 
-	for {
-		if nextAlarmTime > procUntilTime && nextSendtime > procUntilTime {
-			break
-		}
+	for nextEventTime <= procUntilTime {
+		it := d.scheduler.PopNext()
+		simplelogger.AssertTrue(it.Timestamp == nextEventTime)
+		d.advanceTime(nextEventTime)
 
-		if nextAlarmTime <= nextSendtime {
-			// process next alarm
-			d.advanceTime(nextAlarmTime)
-			nextAlarm := d.alarmMgr.NextAlarm()
-			simplelogger.AssertNotNil(nextAlarm)
-			d.advanceNodeTime(nextAlarm.NodeId, nextAlarm.Timestamp, false)
-			// mark the node as alive in the alarm
+		if it.Fail {
+			d.handleFailureControlEvent(it.NodeId, it.Timestamp)
+		} else if it.Send == nil {
+			// process next alarm; this marks the node as alive
+			d.advanceNodeTime(it.NodeId, it.Timestamp, false)
 		} else {
 			// process the send event
-			s := d.sendQueue.PopNext()
-			simplelogger.AssertTrue(s.Timestamp == nextSendtime)
-			d.advanceTime(nextSendtime)
-			// construct the message
-			if !d.cfg.NoPcap {
-				d.pcapFrameChan <- pcapFrameItem{nextSendtime, s.Data[1:]}
-			}
+			s := it.Send
 			if d.cfg.DumpPackets {
 				d.dumpPacket(s)
 			}
+			t0 := time.Now()
 			d.sendNodeMessage(s)
+			d.perf.recordSend(time.Since(t0))
+			d.releaseSendItem(s)
 		}
 
-		nextAlarmTime = d.alarmMgr.NextTimestamp()
-		nextSendtime = d.sendQueue.NextTimestamp()
+		nextEventTime = d.scheduler.NextTimestamp()
 	}
 
 	return len(d.nodes) > 0
 }
 
 func (d *Dispatcher) eventsReader() {
-	udpln := d.udpln
-	readbuf := make([]byte, 4096)
+	transport := d.transport
 
 	for {
 		// wait until all nodes are sleepd
-		n, srcaddr, err := udpln.ReadFromUDP(readbuf)
+		evt := getEvent()
+		n, nodeid, srcaddr, err := transport.ReadEvent(evt.payload[:])
 		if err != nil {
+			putEvent(evt)
+
 			if nerr, ok := err.(net.Error); ok && nerr.Temporary() {
 				time.Sleep(time.Millisecond * 100)
 				continue
 			}
 
-			simplelogger.Infof("UDP events reader quit.")
+			simplelogger.Infof("events reader quit.")
 			break
 		}
 
@@ -500,21 +687,14 @@ func (d *Dispatcher) eventsReader() {
 			simplelogger.Panicf("message length too sort: %d", n)
 		}
 
-		delay := binary.LittleEndian.Uint64(readbuf[:8])
-		typ := readbuf[8]
-		datalen := binary.LittleEndian.Uint16(readbuf[9:11])
-		nodeid := srcaddr.Port - d.cfg.Port
-
-		data := make([]byte, n-11)
-		copy(data, readbuf[11:n])
-		evt := &event{
-			NodeId:  nodeid,
-			Delay:   delay,
-			Type:    typ,
-			DataLen: datalen,
-			Data:    data,
-			SrcAddr: srcaddr,
-		}
+		// the datagram is read directly into the pooled event's payload buffer,
+		// so no per-event allocation or copy is needed
+		evt.Delay = binary.LittleEndian.Uint64(evt.payload[:8])
+		evt.Type = evt.payload[8]
+		evt.DataLen = binary.LittleEndian.Uint16(evt.payload[9:11])
+		evt.NodeId = nodeid
+		evt.Data = evt.payload[11:n]
+		evt.SrcAddr = srcaddr
 
 		d.eventChan <- evt
 	}
@@ -544,17 +724,24 @@ func (d *Dispatcher) advanceNodeTime(id NodeId, timestamp uint64, force bool) {
 	binary.LittleEndian.PutUint16(msg[9:11], 0)
 	node.SendMessage(msg)
 	node.CurTime = timestamp
-	if timestamp > oldTime {
-		node.failureCtrl.OnTimeAdvanced(oldTime)
-	}
 
-	d.alarmMgr.SetNotified(id)
+	d.scheduler.SetNotified(id)
 	d.setAlive(id)
 	if d.isWatching(id) {
 		simplelogger.Warnf("Node %d >>> advance time %v -> %v", id, oldTime, timestamp)
 	}
 }
 
+// handleFailureControlEvent executes a due fail/recover transition of a node.
+func (d *Dispatcher) handleFailureControlEvent(id NodeId, timestamp uint64) {
+	node := d.nodes[id]
+	if node == nil {
+		return
+	}
+
+	node.failureCtrl.onTimedEvent(timestamp)
+}
+
 // SendToUART sends data to virtual time UART of the target node.
 func (d *Dispatcher) SendToUART(id NodeId, data []byte) {
 	node := d.nodes[id]
@@ -573,11 +760,8 @@ func (d *Dispatcher) SendToUART(id NodeId, data []byte) {
 	node.SendMessage(msg)
 
 	node.CurTime = timestamp
-	if timestamp > oldTime {
-		node.failureCtrl.OnTimeAdvanced(oldTime)
-	}
 
-	d.alarmMgr.SetNotified(node.Id)
+	d.scheduler.SetNotified(node.Id)
 	d.setAlive(node.Id)
 }
 
@@ -599,18 +783,18 @@ func (d *Dispatcher) sendNodeMessage(sit *sendItem) {
 		return
 	}
 
-	pktinfo := dissectpkt.Dissect(sit.Data)
-	pktframe := pktinfo.MacFrame
+	// dissect the frame header lazily from the raw slice, without allocating
+	pktframe := wpan.MacFrameView(sit.Data)
 
 	// try to dispatch the message by extaddr directly
 	dispatchedByDstAddr := false
-	dstAddrMode := pktframe.FrameControl.DstAddrMode()
+	dstAddrMode := pktframe.FrameControl().DstAddrMode()
 
 	if dstAddrMode == wpan.DstAddrModeExtended {
 		// the message should only be dispatched to the target node with the extaddr
-		dstnode := d.extaddrMap[pktframe.DstAddrExtended]
+		dstnode := d.extaddrMap[pktframe.DstAddrExtended()]
 		if dstnode != srcnode && dstnode != nil {
-			if d.checkRadioReachable(srcnode, dstnode) {
+			if d.checkRadioReachable(srcnode, dstnode) && d.nodeListensOnChannel(dstnode, pktframe.Channel()) {
 				d.sendOneMessage(sit, srcnode, dstnode)
 				d.visSendFrame(srcnodeid, dstnode.Id, pktframe)
 			} else {
@@ -625,14 +809,14 @@ func (d *Dispatcher) sendNodeMessage(sit *sendItem) {
 
 		dispatchedByDstAddr = true
 	} else if dstAddrMode == wpan.DstAddrModeShort {
-		if pktframe.DstAddrShort != threadconst.BroadcastRloc16 {
+		if pktframe.DstAddrShort() != threadconst.BroadcastRloc16 {
 			// unicast message should only be dispatched to target node with the rloc16
-			dstnodes := d.rloc16Map[pktframe.DstAddrShort]
+			dstnodes := d.rloc16Map[pktframe.DstAddrShort()]
 			dispatchCnt := 0
 
 			if len(dstnodes) > 0 {
 				for _, dstnode := range dstnodes {
-					if d.checkRadioReachable(srcnode, dstnode) {
+					if d.checkRadioReachable(srcnode, dstnode) && d.nodeListensOnChannel(dstnode, pktframe.Channel()) {
 						d.sendOneMessage(sit, srcnode, dstnode)
 						d.visSendFrame(srcnodeid, dstnode.Id, pktframe)
 						dispatchCnt++
@@ -653,9 +837,26 @@ func (d *Dispatcher) sendNodeMessage(sit *sendItem) {
 
 	if !dispatchedByDstAddr {
 		// TODO: optimize ACK message dispatching by sending it only to the correct node(s)
-		for _, dstnode := range d.nodes {
-			if d.checkRadioReachable(srcnode, dstnode) {
-				d.sendOneMessage(sit, srcnode, dstnode)
+		ch := pktframe.Channel()
+		neighbors := d.radioNeighbors(srcnode)
+		onChannel := d.channelNodes[ch]
+		unknown := d.channelNodes[0]
+
+		if ch != 0 && len(onChannel)+len(unknown) < len(neighbors) {
+			// few nodes listen on this channel; walking the channel index and
+			// checking reachability is cheaper than filtering all neighbors
+			for _, bucket := range []map[NodeId]*Node{onChannel, unknown} {
+				for _, dstnode := range bucket {
+					if d.checkRadioReachable(srcnode, dstnode) {
+						d.sendOneMessage(sit, srcnode, dstnode)
+					}
+				}
+			}
+		} else {
+			for _, dstnode := range neighbors {
+				if d.nodeListensOnChannel(dstnode, ch) {
+					d.sendOneMessage(sit, srcnode, dstnode)
+				}
 			}
 		}
 
@@ -663,8 +864,72 @@ func (d *Dispatcher) sendNodeMessage(sit *sendItem) {
 	}
 }
 
+// releaseSendItem hands a dispatched frame to the pcap writer (which recycles
+// its pooled event after writing) or recycles the event directly when pcap is
+// disabled; the send item itself returns to its pool in both cases.
+func (d *Dispatcher) releaseSendItem(s *sendItem) {
+	if !d.cfg.NoPcap {
+		d.pcapFrameChan <- pcapFrameItem{s.Timestamp, s.NodeId, s.Data[1:], s.evt}
+	} else if s.evt != nil {
+		putEvent(s.evt)
+	}
+	putSendItem(s)
+}
+
 func (d *Dispatcher) checkRadioReachable(src *Node, dst *Node) bool {
-	return dst != src && src.GetDistanceTo(dst) <= src.radioRange
+	return dst != src && d.radioModel.CheckReachable(src, dst)
+}
+
+func (d *Dispatcher) addNodeChannel(node *Node) {
+	bucket := d.channelNodes[node.channel]
+	if bucket == nil {
+		bucket = map[NodeId]*Node{}
+		d.channelNodes[node.channel] = bucket
+	}
+	bucket[node.Id] = node
+}
+
+func (d *Dispatcher) removeNodeChannel(node *Node) {
+	delete(d.channelNodes[node.channel], node.Id)
+}
+
+// SetNodeChannel updates the per-channel node index when a node's listening
+// channel becomes known or changes.
+func (d *Dispatcher) SetNodeChannel(id NodeId, channel uint8) {
+	node := d.nodes[id]
+	simplelogger.AssertNotNil(node)
+
+	if node.channel == channel {
+		return
+	}
+
+	d.removeNodeChannel(node)
+	node.channel = channel
+	d.addNodeChannel(node)
+}
+
+// nodeListensOnChannel reports whether dst receives frames transmitted on the
+// given channel; unknown channels (0) never filter.
+func (d *Dispatcher) nodeListensOnChannel(dst *Node, channel uint8) bool {
+	return channel == 0 || dst.channel == 0 || dst.channel == channel
+}
+
+// radioNeighbors returns all nodes within src's radio range, using a per-node
+// cached list that is invalidated whenever any node is added, deleted or moved.
+func (d *Dispatcher) radioNeighbors(src *Node) []*Node {
+	gen := d.spatialIndex.generation
+	if src.neighborCacheGen == gen {
+		return src.neighborCache
+	}
+
+	src.neighborCache = src.neighborCache[:0]
+	d.spatialIndex.Query(src.X, src.Y, d.radioModel.neighborRadius(src), func(dst *Node) {
+		if dst != src && d.radioModel.CheckReachable(src, dst) {
+			src.neighborCache = append(src.neighborCache, dst)
+		}
+	})
+	src.neighborCacheGen = gen
+	return src.neighborCache
 }
 
 func (d *Dispatcher) sendOneMessage(sit *sendItem, srcnode *Node, dstnode *Node) {
@@ -676,12 +941,8 @@ func (d *Dispatcher) sendOneMessage(sit *sendItem, srcnode *Node, dstnode *Node)
 			return
 		}
 
-		if d.globalPacketLossRatio > 0 {
-			datalen := len(sit.Data)
-			succRate := math.Pow(1.0-d.globalPacketLossRatio, float64(datalen)/128.0)
-			if rand.Float64() >= succRate {
-				return
-			}
+		if d.loss.lose(srcnode.Id, dstnode.Id, len(sit.Data)) {
+			return
 		}
 	}
 
@@ -697,12 +958,9 @@ func (d *Dispatcher) sendOneMessage(sit *sendItem, srcnode *Node, dstnode *Node)
 
 	dstnode.Send(elapsed, sit.Data)
 	dstnode.CurTime = timestamp
-	if timestamp > oldTime {
-		dstnode.failureCtrl.OnTimeAdvanced(oldTime)
-	}
 
 	dstnodeid := dstnode.Id
-	d.alarmMgr.SetNotified(dstnodeid)
+	d.scheduler.SetNotified(dstnodeid)
 	d.setAlive(dstnodeid)
 
 	if d.isWatching(dstnodeid) {
@@ -717,7 +975,11 @@ func (d *Dispatcher) sendOneMessage(sit *sendItem, srcnode *Node, dstnode *Node)
 func (d *Dispatcher) newNode(nodeid NodeId, x, y int, radioRange int) (node *Node) {
 	node = newNode(d, nodeid, x, y, radioRange)
 	d.nodes[nodeid] = node
-	d.alarmMgr.AddNode(nodeid)
+	d.spatialIndex.Insert(node)
+	d.addNodeChannel(node)
+	d.radioModel.onNodeAdded(node)
+	d.topology.onNodeAdded(node)
+	d.scheduler.AddNode(nodeid)
 	d.setAlive(nodeid)
 
 	d.vis.AddNode(nodeid, x, y, radioRange)
@@ -765,10 +1027,29 @@ func (d *Dispatcher) pcapFrameWriter() {
 			simplelogger.Errorf("failed to close pcap: %v", err)
 		}
 	}()
-	for item := range d.pcapFrameChan {
-		err := d.pcap.AppendFrame(item.Ustime, item.Data)
-		if err != nil {
-			simplelogger.Errorf("write pcap failed:%+v", err)
+
+	flushTicker := time.NewTicker(d.cfg.PcapFlushInterval)
+	defer flushTicker.Stop()
+
+	for {
+		select {
+		case item, ok := <-d.pcapFrameChan:
+			if !ok {
+				return
+			}
+			err := d.pcap.AppendFrame(item.Ustime, item.NodeId, item.Data)
+			if err != nil {
+				simplelogger.Errorf("write pcap failed:%+v", err)
+			}
+			if item.evt != nil {
+				putEvent(item.evt)
+			}
+		case <-flushTicker.C:
+			// push buffered frames through so an observer tailing the capture
+			// sees them even between go periods
+			if err := d.pcap.Flush(); err != nil {
+				simplelogger.Errorf("flush pcap failed:%+v", err)
+			}
 		}
 	}
 }
@@ -807,6 +1088,10 @@ func (d *Dispatcher) handleStatusPush(srcid NodeId, data string) {
 			rloc16, err := strconv.Atoi(sp[1])
 			simplelogger.PanicIfError(err)
 			d.setNodeRloc16(srcid, uint16(rloc16))
+		} else if sp[0] == "channel" {
+			channel, err := strconv.Atoi(sp[1])
+			simplelogger.PanicIfError(err)
+			d.SetNodeChannel(srcid, uint8(channel))
 		} else if sp[0] == "ping_request" {
 			// e.x. ping_request=fdde:ad00:beef:0:556:90c8:ffaf:b7a3$0$4026600960
 			args := strings.Split(sp[1], ",")
@@ -833,35 +1118,40 @@ func (d *Dispatcher) handleStatusPush(srcid NodeId, data string) {
 			// set partition id
 			parid, err := strconv.ParseUint(sp[1], 16, 32)
 			simplelogger.PanicIfError(err)
-			srcnode.PartitionId = uint32(parid)
+			d.topology.setNodePartition(srcnode, uint32(parid))
 			d.vis.SetNodePartitionId(srcid, uint32(parid))
 		} else if sp[0] == "router_added" {
 			extaddr, err := strconv.ParseUint(sp[1], 16, 64)
 			simplelogger.PanicIfError(err)
+			d.topology.addRouterLink(srcid, extaddr)
 			if d.visOptions.RouterTable {
 				d.vis.AddRouterTable(srcid, extaddr)
 			}
 		} else if sp[0] == "router_removed" {
 			extaddr, err := strconv.ParseUint(sp[1], 16, 64)
 			simplelogger.PanicIfError(err)
+			d.topology.removeRouterLink(srcid, extaddr)
 			if d.visOptions.RouterTable {
 				d.vis.RemoveRouterTable(srcid, extaddr)
 			}
 		} else if sp[0] == "child_added" {
 			extaddr, err := strconv.ParseUint(sp[1], 16, 64)
 			simplelogger.PanicIfError(err)
+			d.topology.addChild(srcid, extaddr)
 			if d.visOptions.ChildTable {
 				d.vis.AddChildTable(srcid, extaddr)
 			}
 		} else if sp[0] == "child_removed" {
 			extaddr, err := strconv.ParseUint(sp[1], 16, 64)
 			simplelogger.PanicIfError(err)
+			d.topology.removeChild(srcid, extaddr)
 			if d.visOptions.ChildTable {
 				d.vis.RemoveChildTable(srcid, extaddr)
 			}
 		} else if sp[0] == "parent" {
 			extaddr, err := strconv.ParseUint(sp[1], 16, 64)
 			simplelogger.PanicIfError(err)
+			d.topology.setParent(srcid, extaddr)
 			d.vis.SetParent(srcid, extaddr)
 		} else if sp[0] == "joiner_state" {
 			joinerState, err := strconv.Atoi(sp[1])
@@ -881,25 +1171,50 @@ func (d *Dispatcher) handleStatusPush(srcid NodeId, data string) {
 }
 
 func (d *Dispatcher) AddNode(nodeid NodeId, x, y int, radioRange int) {
+	d.AddNodeNoWait(nodeid, x, y, radioRange)
+	d.WaitNodesReady([]NodeId{nodeid})
+}
+
+// AddNodeNoWait registers a node without waiting for it to become ready. The
+// caller must call WaitNodesReady before sending the node any commands; bulk
+// node creation registers a whole batch first so that the waits overlap.
+func (d *Dispatcher) AddNodeNoWait(nodeid NodeId, x, y int, radioRange int) {
 	simplelogger.AssertNil(d.nodes[nodeid])
 	simplelogger.Infof("dispatcher add node %d", nodeid)
-	node := d.newNode(nodeid, x, y, radioRange)
+	d.newNode(nodeid, x, y, radioRange)
+}
 
-	if !d.cfg.Real {
-		// Wait until node's extended address is emitted (but not for real devices)
-		// This helps OTNS to make sure that the child process is ready to receive UDP events
-		t0 := time.Now()
-		deadline := t0.Add(time.Second * 10)
-		for node.ExtAddr == InvalidExtAddr && time.Now().Before(deadline) {
-			d.RecvEvents()
-		}
+// WaitNodesReady waits until all given nodes have emitted their extended
+// addresses (but not for real devices). This helps OTNS to make sure that the
+// child processes are ready to receive UDP events.
+func (d *Dispatcher) WaitNodesReady(nodeids []NodeId) {
+	if d.cfg.Real {
+		return
+	}
 
-		if node.ExtAddr == InvalidExtAddr {
-			simplelogger.Panicf("expect node %d's extaddr to be valid, but failed", nodeid)
-		} else {
-			takeTime := time.Since(t0)
-			simplelogger.Debugf("node %d's extaddr becomes valid in %v", nodeid, takeTime)
+	t0 := time.Now()
+	deadline := t0.Add(time.Second*10 + time.Millisecond*50*time.Duration(len(nodeids)))
+
+	pending := make([]NodeId, len(nodeids))
+	copy(pending, nodeids)
+
+	for len(pending) > 0 && time.Now().Before(deadline) {
+		d.RecvEvents()
+
+		left := pending[:0]
+		for _, nodeid := range pending {
+			if d.nodes[nodeid].ExtAddr == InvalidExtAddr {
+				left = append(left, nodeid)
+			}
 		}
+		pending = left
+	}
+
+	if len(pending) > 0 {
+		simplelogger.Panicf("expect nodes %v extaddr to be valid, but failed", pending)
+	} else {
+		takeTime := time.Since(t0)
+		simplelogger.Debugf("%d node extaddrs become valid in %v", len(nodeids), takeTime)
 	}
 }
 
@@ -992,14 +1307,25 @@ func (d *Dispatcher) visStatusPushTransmit(srcnode *Node, s string) {
 	}
 }
 
-func (d *Dispatcher) visSendFrame(srcid NodeId, dstid NodeId, pktframe *wpan.MacFrame) {
-	d.visSend(srcid, dstid, &visualize.MsgVisualizeInfo{
-		Channel:         pktframe.Channel,
-		FrameControl:    pktframe.FrameControl,
-		Seq:             pktframe.Seq,
-		DstAddrShort:    pktframe.DstAddrShort,
-		DstAddrExtended: pktframe.DstAddrExtended,
-	})
+func (d *Dispatcher) visSendFrame(srcid NodeId, dstid NodeId, pktframe wpan.MacFrameView) {
+	fc := pktframe.FrameControl()
+	visInfo := visualize.MsgVisualizeInfo{
+		Channel:      pktframe.Channel(),
+		FrameControl: fc,
+		Seq:          pktframe.Seq(),
+	}
+
+	// the address fields are only present in non-ACK frames
+	if fc.FrameType() != wpan.FrameTypeAck {
+		switch fc.DstAddrMode() {
+		case wpan.DstAddrModeShort:
+			visInfo.DstAddrShort = pktframe.DstAddrShort()
+		case wpan.DstAddrModeExtended:
+			visInfo.DstAddrExtended = pktframe.DstAddrExtended()
+		}
+	}
+
+	d.visSend(srcid, dstid, &visInfo)
 }
 
 func (d *Dispatcher) visSend(srcid NodeId, dstid NodeId, visInfo *visualize.MsgVisualizeInfo) {
@@ -1036,6 +1362,8 @@ func (d *Dispatcher) advanceTime(ts uint64) {
 		if d.cfg.Real {
 			d.syncAllNodes()
 		}
+
+		d.trafficGen.onTimeAdvanced(ts)
 	}
 }
 
@@ -1107,7 +1435,10 @@ func (d *Dispatcher) SetNodePos(id NodeId, x, y int) {
 	node := d.nodes[id]
 	simplelogger.AssertNotNil(node)
 
+	oldX, oldY := node.X, node.Y
 	node.X, node.Y = x, y
+	d.spatialIndex.Move(node, oldX, oldY)
+	d.radioModel.onNodePosChanged(node)
 	d.vis.SetNodePos(id, x, y)
 }
 
@@ -1118,6 +1449,11 @@ func (d *Dispatcher) DeleteNode(id NodeId) {
 	delete(d.nodes, id)
 	delete(d.aliveNodes, id)
 	delete(d.watchingNodes, id)
+	delete(d.sendDirtyNodes, id)
+	d.spatialIndex.Remove(node)
+	d.removeNodeChannel(node)
+	d.radioModel.onNodeDeleted(node)
+	d.topology.onNodeDeleted(node)
 	if node.Rloc16 != threadconst.InvalidRloc16 {
 		d.rloc16Map.Remove(node.Rloc16, node)
 	}
@@ -1125,7 +1461,7 @@ func (d *Dispatcher) DeleteNode(id NodeId) {
 		simplelogger.AssertTrue(d.extaddrMap[node.ExtAddr] == node)
 		delete(d.extaddrMap, node.ExtAddr)
 	}
-	d.alarmMgr.DeleteNode(id)
+	d.scheduler.DeleteNode(id)
 	d.deletedNodes[id] = struct{}{}
 
 	d.vis.DeleteNode(id)
@@ -1171,17 +1507,42 @@ func (d *Dispatcher) GetSpeed() float64 {
 	return d.speed
 }
 
+// achievedSpeed returns the actually achieved simulating speed (simulated vs
+// real time) of the current go period.
+func (d *Dispatcher) achievedSpeed() float64 {
+	elapsedRealUs := time.Since(d.speedStartRealTime) / time.Microsecond
+	if elapsedRealUs <= 0 {
+		return 0
+	}
+
+	return float64(d.CurTime-d.speedStartTime) / float64(elapsedRealUs)
+}
+
+// GetPerfStats returns a snapshot of the dispatcher performance statistics.
+// It is safe to call from any goroutine.
+func (d *Dispatcher) GetPerfStats() PerfStats {
+	return d.perf.Snapshot()
+}
+
 func (d *Dispatcher) GetGlobalMessageDropRatio() float64 {
-	return d.globalPacketLossRatio
+	return d.loss.globalPlr
 }
 
 func (d *Dispatcher) SetGlobalPacketLossRatio(plr float64) {
-	if plr > 1 {
-		plr = 1
-	} else if plr < 0 {
-		plr = 0
-	}
-	d.globalPacketLossRatio = plr
+	d.loss.setGlobalRatio(plr)
+}
+
+// SetLinkPacketLossRatio sets the loss ratio of the directed link src->dst,
+// overriding the global ratio for that link; a negative ratio removes the
+// override.
+func (d *Dispatcher) SetLinkPacketLossRatio(src, dst NodeId, plr float64) {
+	d.loss.setLinkRatio(src, dst, plr)
+}
+
+// SetPacketLossSeed reseeds the packet loss engine; runs with the same seed
+// and event order lose exactly the same frames.
+func (d *Dispatcher) SetPacketLossSeed(seed int64) {
+	d.loss.setSeed(seed)
 }
 
 func (d *Dispatcher) convertNodeMilliTime(node *Node, milliTime uint32) uint64 {
@@ -1234,7 +1595,17 @@ func (d *Dispatcher) NotifyCommand(nodeid NodeId) {
 	d.setAlive(nodeid)
 }
 
+// dumpPacket hands a dispatched frame to the binary dump sink when one is
+// configured, keeping hex-on-stdout for interactive use. The frame is copied
+// because item.Data aliases a pooled event.
 func (d *Dispatcher) dumpPacket(item *sendItem) {
+	if d.dumpFrameChan != nil {
+		data := make([]byte, len(item.Data))
+		copy(data, item.Data)
+		d.dumpFrameChan <- dumpFrameItem{item.Timestamp, item.NodeId, data}
+		return
+	}
+
 	sb := strings.Builder{}
 	_, _ = fmt.Fprintf(&sb, "DUMP:PACKET:%d:%d:", item.Timestamp, item.NodeId)
 	for _, b := range item.Data {
@@ -1244,6 +1615,63 @@ func (d *Dispatcher) dumpPacket(item *sendItem) {
 	_, _ = fmt.Fprintf(os.Stdout, "%s\n", sb.String())
 }
 
+// openDumpSink opens the binary packet dump destination: a tcp:// or unix://
+// target is dialed as a socket, anything else is created as a file.
+func openDumpSink(target string) (io.WriteCloser, error) {
+	if strings.HasPrefix(target, "tcp://") {
+		return net.Dial("tcp", strings.TrimPrefix(target, "tcp://"))
+	}
+	if strings.HasPrefix(target, "unix://") {
+		return net.Dial("unix", strings.TrimPrefix(target, "unix://"))
+	}
+	return os.Create(target)
+}
+
+// dumpFrameWriter drains dumpFrameChan to the binary dump sink. Each record is
+// an 8-byte timestamp (µs), a 4-byte node id and a 2-byte frame length, all
+// little endian, followed by the frame bytes. Buffered records are flushed
+// whenever the writer catches up with the channel, so a live consumer sees
+// frames without the dispatcher having to slow down for it.
+func (d *Dispatcher) dumpFrameWriter() {
+	d.waitGroup.Add(1)
+	defer d.waitGroup.Done()
+
+	defer func() {
+		err := d.dumpSink.Close()
+		if err != nil {
+			simplelogger.Errorf("failed to close packet dump sink: %v", err)
+		}
+	}()
+
+	w := bufio.NewWriterSize(d.dumpSink, 65536)
+	var header [14]byte
+
+	for item := range d.dumpFrameChan {
+		binary.LittleEndian.PutUint64(header[0:8], item.Ustime)
+		binary.LittleEndian.PutUint32(header[8:12], uint32(item.NodeId))
+		binary.LittleEndian.PutUint16(header[12:14], uint16(len(item.Data)))
+
+		if _, err := w.Write(header[:]); err != nil {
+			simplelogger.Errorf("write packet dump failed: %+v", err)
+			continue
+		}
+		if _, err := w.Write(item.Data); err != nil {
+			simplelogger.Errorf("write packet dump failed: %+v", err)
+			continue
+		}
+
+		if len(d.dumpFrameChan) == 0 {
+			if err := w.Flush(); err != nil {
+				simplelogger.Errorf("flush packet dump failed: %+v", err)
+			}
+		}
+	}
+
+	if err := w.Flush(); err != nil {
+		simplelogger.Errorf("flush packet dump failed: %+v", err)
+	}
+}
+
 func (d *Dispatcher) setNodeRole(id NodeId, role OtDeviceRole) {
 	node := d.nodes[id]
 	if node == nil {
@@ -1317,3 +1745,21 @@ func (d *Dispatcher) CollectCoapMessages() []*CoapMessage {
 		return nil
 	}
 }
+
+// QueryCoapMessages returns the collected messages matching the filter
+// without draining them.
+func (d *Dispatcher) QueryCoapMessages(filter CoapMessageFilter) []*CoapMessage {
+	if d.coaps != nil {
+		return d.coaps.QueryMessages(filter)
+	} else {
+		return nil
+	}
+}
+
+// SetCoapsLogFile enables CoAP collection with streaming export: messages are
+// appended to the given file when they are evicted from the bounded in-memory
+// ring or drained by a collection.
+func (d *Dispatcher) SetCoapsLogFile(filename string) error {
+	d.EnableCoaps()
+	return d.coaps.setLogFile(filename)
+}
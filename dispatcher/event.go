@@ -28,6 +28,7 @@ package dispatcher
 
 import (
 	"net"
+	"sync"
 
 	. "github.com/openthread/ot-ns/types"
 )
@@ -37,8 +38,15 @@ const (
 	eventTypeRadioReceived = 1
 	eventTypeUartWrite     = 2
 	eventTypeStatusPush    = 5
+	// binary TLV status push (see status_push.go); nodes that support the
+	// binary protocol use this type instead of eventTypeStatusPush
+	eventTypeStatusPushBinary = 6
 )
 
+// eventPayloadBufSize is the maximum size of one event datagram, including the
+// 11-byte header.
+const eventPayloadBufSize = 4096
+
 type eventType = uint8
 
 type event struct {
@@ -47,5 +55,26 @@ type event struct {
 	NodeId  NodeId
 	DataLen uint16
 	Data    []byte
-	SrcAddr *net.UDPAddr
+	SrcAddr net.Addr
+
+	// payload is the pooled backing storage of Data for events read by
+	// eventsReader; such events are recycled via putEvent once Data is no
+	// longer referenced.
+	payload [eventPayloadBufSize]byte
+}
+
+var eventPool = sync.Pool{
+	New: func() interface{} {
+		return &event{}
+	},
+}
+
+func getEvent() *event {
+	return eventPool.Get().(*event)
+}
+
+func putEvent(evt *event) {
+	evt.Data = nil
+	evt.SrcAddr = nil
+	eventPool.Put(evt)
 }
@@ -0,0 +1,189 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math"
+	"math/rand"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+// lossTableSize covers all 802.15.4 frame lengths; longer payloads share the
+// last entry.
+const lossTableSize = 256
+
+// lossTable precomputes the per-frame-length delivery success probability for
+// one loss ratio, so deciding a frame costs an index and a compare instead of
+// a math.Pow call.
+type lossTable [lossTableSize]float64
+
+func newLossTable(plr float64) *lossTable {
+	t := &lossTable{}
+	for l := 0; l < lossTableSize; l++ {
+		t[l] = math.Pow(1.0-plr, float64(l)/128.0)
+	}
+	return t
+}
+
+func (t *lossTable) succRate(datalen int) float64 {
+	if datalen >= lossTableSize {
+		datalen = lossTableSize - 1
+	}
+	return t[datalen]
+}
+
+type lossLinkKey struct {
+	src NodeId
+	dst NodeId
+}
+
+// lossLink holds the per-link loss state: the table of its effective loss
+// ratio (nil for lossless links) and a dedicated PRNG, so the draw sequence
+// on one link is independent of traffic on all other links.
+type lossLink struct {
+	table *lossTable
+	rng   *rand.Rand
+}
+
+// lossEngine decides frame deliveries for sendOneMessage. Loss is configured
+// globally or per directed link; success probabilities are precomputed into
+// tables shared between links with equal ratios, and every link draws from
+// its own seeded PRNG, so two runs with the same seed and the same event
+// order lose exactly the same frames.
+type lossEngine struct {
+	seed        int64
+	globalPlr   float64
+	globalTable *lossTable
+	linkPlrs    map[lossLinkKey]float64
+	links       map[lossLinkKey]*lossLink
+	tables      map[float64]*lossTable
+}
+
+func newLossEngine(seed int64) *lossEngine {
+	return &lossEngine{
+		seed:     seed,
+		linkPlrs: map[lossLinkKey]float64{},
+		links:    map[lossLinkKey]*lossLink{},
+		tables:   map[float64]*lossTable{},
+	}
+}
+
+func (le *lossEngine) table(plr float64) *lossTable {
+	t := le.tables[plr]
+	if t == nil {
+		t = newLossTable(plr)
+		le.tables[plr] = t
+	}
+	return t
+}
+
+// setSeed reseeds the engine, discarding all per-link PRNG state; a rerun
+// with the same seed draws the same loss sequence from the start.
+func (le *lossEngine) setSeed(seed int64) {
+	le.seed = seed
+	le.links = map[lossLinkKey]*lossLink{}
+}
+
+func (le *lossEngine) setGlobalRatio(plr float64) {
+	if plr > 1 {
+		plr = 1
+	} else if plr < 0 {
+		plr = 0
+	}
+
+	le.globalPlr = plr
+	if plr > 0 {
+		le.globalTable = le.table(plr)
+	} else {
+		le.globalTable = nil
+	}
+
+	// links without an explicit ratio follow the global one
+	for key, l := range le.links {
+		if _, ok := le.linkPlrs[key]; !ok {
+			l.table = le.globalTable
+		}
+	}
+}
+
+// setLinkRatio sets the loss ratio of the directed link src->dst, overriding
+// the global ratio for that link; a negative value removes the override.
+func (le *lossEngine) setLinkRatio(src, dst NodeId, plr float64) {
+	key := lossLinkKey{src, dst}
+
+	if plr < 0 {
+		delete(le.linkPlrs, key)
+		if l := le.links[key]; l != nil {
+			l.table = le.globalTable
+		}
+		return
+	}
+
+	if plr > 1 {
+		plr = 1
+	}
+	le.linkPlrs[key] = plr
+	if l := le.links[key]; l != nil {
+		l.table = le.table(plr)
+	}
+}
+
+// lose reports whether a frame of datalen bytes from src to dst is lost.
+func (le *lossEngine) lose(src, dst NodeId, datalen int) bool {
+	key := lossLinkKey{src, dst}
+	l := le.links[key]
+
+	if l == nil {
+		table := le.globalTable
+		if plr, ok := le.linkPlrs[key]; ok {
+			table = le.table(plr)
+		}
+		if table == nil {
+			// no PRNG state is kept for lossless links
+			return false
+		}
+		l = &lossLink{table: table, rng: rand.New(rand.NewSource(le.linkSeed(key)))}
+		le.links[key] = l
+	}
+
+	if l.table == nil {
+		return false
+	}
+	return l.rng.Float64() >= l.table.succRate(datalen)
+}
+
+// linkSeed derives a per-link seed from the engine seed and the directed node
+// pair, so a link's draw sequence does not depend on when it first carries
+// traffic.
+func (le *lossEngine) linkSeed(key lossLinkKey) int64 {
+	h := uint64(le.seed) ^ uint64(key.src)*0x9E3779B97F4A7C15 ^ uint64(key.dst)*0xC2B2AE3D27D4EB4F
+	h ^= h >> 33
+	h *= 0xFF51AFD7ED558CCD
+	h ^= h >> 33
+	return int64(h)
+}
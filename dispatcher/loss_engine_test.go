@@ -0,0 +1,113 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+)
+
+func TestLossTable(t *testing.T) {
+	table := newLossTable(0.1)
+	for _, datalen := range []int{0, 1, 64, 128, 255} {
+		assert.InDelta(t, math.Pow(0.9, float64(datalen)/128.0), table.succRate(datalen), 1e-12)
+	}
+	// lengths beyond the table share the last entry
+	assert.Equal(t, table.succRate(lossTableSize-1), table.succRate(10000))
+}
+
+func TestLossEngine_Deterministic(t *testing.T) {
+	drawLosses := func(seed int64) []bool {
+		le := newLossEngine(seed)
+		le.setGlobalRatio(0.5)
+		var losses []bool
+		for i := 0; i < 100; i++ {
+			losses = append(losses, le.lose(1, 2, 100))
+			losses = append(losses, le.lose(2, 1, 100))
+		}
+		return losses
+	}
+
+	assert.Equal(t, drawLosses(1), drawLosses(1))
+	assert.NotEqual(t, drawLosses(1), drawLosses(2))
+
+	// reseeding replays the sequence from the start
+	le := newLossEngine(1)
+	le.setGlobalRatio(0.5)
+	first := le.lose(1, 2, 100)
+	for i := 0; i < 10; i++ {
+		le.lose(1, 2, 100)
+	}
+	le.setSeed(1)
+	assert.Equal(t, first, le.lose(1, 2, 100))
+}
+
+func TestLossEngine_LinkIndependence(t *testing.T) {
+	// the draw sequence of a link must not depend on traffic of other links
+	le1 := newLossEngine(1)
+	le1.setGlobalRatio(0.5)
+	var losses1 []bool
+	for i := 0; i < 100; i++ {
+		losses1 = append(losses1, le1.lose(1, 2, 100))
+	}
+
+	le2 := newLossEngine(1)
+	le2.setGlobalRatio(0.5)
+	var losses2 []bool
+	for i := 0; i < 100; i++ {
+		le2.lose(3, 4, 100)
+		losses2 = append(losses2, le2.lose(1, 2, 100))
+	}
+
+	assert.Equal(t, losses1, losses2)
+}
+
+func TestLossEngine_LinkRatios(t *testing.T) {
+	le := newLossEngine(1)
+
+	// without any configured loss nothing is lost and no state is kept
+	for i := 0; i < 100; i++ {
+		assert.False(t, le.lose(1, 2, 100))
+	}
+	assert.Empty(t, le.links)
+
+	// a link override of 1 loses everything, 0 loses nothing
+	le.setLinkRatio(1, 2, 1)
+	le.setLinkRatio(3, 4, 0)
+	le.setGlobalRatio(1)
+	for i := 0; i < 100; i++ {
+		assert.True(t, le.lose(1, 2, 100))
+		assert.False(t, le.lose(3, 4, 100))
+		assert.True(t, le.lose(5, 6, 100), "link without override must follow the global ratio")
+	}
+
+	// removing the override makes the link follow the global ratio again
+	le.setLinkRatio(3, 4, -1)
+	assert.True(t, le.lose(3, 4, 100))
+}
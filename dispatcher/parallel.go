@@ -0,0 +1,175 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"time"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+const (
+	// minPropagationDelayUs is the minimum delay between transmitting a frame
+	// and delivering it to another node. Events closer in time than this can
+	// not causally affect other nodes.
+	minPropagationDelayUs = 1
+	// parallelWindowUs bounds one conservative execution window, i.e. how far
+	// the nodes of one island may run ahead of the dispatcher clock before
+	// their new events are merged back.
+	parallelWindowUs = 1000
+)
+
+// islandIndex assigns every node to its radio-connectivity island. Nodes of
+// different islands can never exchange frames, so their events are causally
+// independent and their node processes may compute in parallel.
+type islandIndex struct {
+	islands    map[NodeId]int
+	count      int
+	generation uint64
+}
+
+func (d *Dispatcher) getIslands() *islandIndex {
+	if d.islands != nil && d.islands.generation == d.spatialIndex.generation {
+		return d.islands
+	}
+
+	d.islands = d.computeIslands()
+	return d.islands
+}
+
+// computeIslands performs a union-find over all radio links.
+func (d *Dispatcher) computeIslands() *islandIndex {
+	parents := make(map[NodeId]NodeId, len(d.nodes))
+	for id := range d.nodes {
+		parents[id] = id
+	}
+
+	var find func(NodeId) NodeId
+	find = func(id NodeId) NodeId {
+		root := parents[id]
+		if root != id {
+			root = find(root)
+			parents[id] = root
+		}
+		return root
+	}
+
+	for id, node := range d.nodes {
+		for _, peer := range d.radioNeighbors(node) {
+			// links are merged in both directions, so nodes with asymmetric
+			// radio ranges still end up in the same island
+			r1, r2 := find(id), find(peer.Id)
+			if r1 != r2 {
+				parents[r1] = r2
+			}
+		}
+	}
+
+	index := &islandIndex{
+		islands:    make(map[NodeId]int, len(d.nodes)),
+		generation: d.spatialIndex.generation,
+	}
+	roots := map[NodeId]int{}
+	for id := range d.nodes {
+		root := find(id)
+		island, ok := roots[root]
+		if !ok {
+			island = len(roots)
+			roots[root] = island
+		}
+		index.islands[id] = island
+	}
+	index.count = len(roots)
+
+	return index
+}
+
+// processParallelBatch pops all events inside the conservative lookahead
+// window and executes, for every island, only the events at that island's
+// earliest pending timestamp; later events are pushed back for the next
+// window. The woken node processes of all islands then compute concurrently
+// until RecvEvents merges their new events back into the scheduler. The
+// dispatcher clock stays at the minimum pending event time while island nodes
+// run ahead of it.
+func (d *Dispatcher) processParallelBatch() {
+	nextEventTime := d.scheduler.NextTimestamp()
+	if nextEventTime > d.pauseTime {
+		return
+	}
+
+	windowEnd := nextEventTime + parallelWindowUs
+	if windowEnd > d.pauseTime {
+		windowEnd = d.pauseTime
+	}
+
+	d.advanceTime(nextEventTime)
+
+	var batch []schedItem
+	for d.scheduler.NextTimestamp() <= windowEnd {
+		batch = append(batch, d.scheduler.PopNext())
+	}
+
+	islands := d.getIslands()
+	levels := make(map[int]uint64, islands.count)
+
+	// the batch is in global timestamp order, so processed frames keep their
+	// time order (e.g. for the pcap writer)
+	for _, evt := range batch {
+		island := islands.islands[evt.NodeId]
+		level, ok := levels[island]
+		if !ok {
+			level = evt.Timestamp
+			levels[island] = level
+		}
+
+		if evt.Timestamp >= level+minPropagationDelayUs {
+			// a later event of an already advanced island; push it back
+			if evt.Send != nil {
+				d.scheduler.AddItem(evt.Send)
+			} else if evt.Fail {
+				d.scheduler.SetFailureTimestamp(evt.NodeId, evt.Timestamp)
+			} else {
+				d.scheduler.SetTimestamp(evt.NodeId, evt.Timestamp)
+			}
+			continue
+		}
+
+		if evt.Send != nil {
+			if d.cfg.DumpPackets {
+				d.dumpPacket(evt.Send)
+			}
+			t0 := time.Now()
+			d.sendNodeMessage(evt.Send)
+			d.perf.recordSend(time.Since(t0))
+			d.releaseSendItem(evt.Send)
+		} else if evt.Fail {
+			d.handleFailureControlEvent(evt.NodeId, evt.Timestamp)
+		} else {
+			d.advanceNodeTime(evt.NodeId, evt.Timestamp, false)
+		}
+	}
+}
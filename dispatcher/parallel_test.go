@@ -0,0 +1,89 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"testing"
+
+	. "github.com/openthread/ot-ns/types"
+	"github.com/stretchr/testify/assert"
+)
+
+func newIslandTestDispatcher(t *testing.T) *Dispatcher {
+	d := &Dispatcher{
+		nodes:        map[NodeId]*Node{},
+		spatialIndex: newSpatialIndex(),
+	}
+	return d
+}
+
+func addIslandTestNode(d *Dispatcher, id NodeId, x, y, radioRange int) *Node {
+	node := &Node{Id: id, X: x, Y: y, radioRange: radioRange}
+	d.nodes[id] = node
+	d.spatialIndex.Insert(node)
+	return node
+}
+
+func TestComputeIslands(t *testing.T) {
+	d := newIslandTestDispatcher(t)
+
+	// island 1: 1 - 2 - 3 chain, island 2: 4 alone
+	addIslandTestNode(d, 1, 0, 0, 150)
+	addIslandTestNode(d, 2, 100, 0, 150)
+	addIslandTestNode(d, 3, 200, 0, 150)
+	addIslandTestNode(d, 4, 1000, 0, 150)
+
+	islands := d.getIslands()
+	assert.Equal(t, 2, islands.count)
+	assert.Equal(t, islands.islands[1], islands.islands[2])
+	assert.Equal(t, islands.islands[2], islands.islands[3])
+	assert.NotEqual(t, islands.islands[1], islands.islands[4])
+}
+
+func TestComputeIslands_AsymmetricRange(t *testing.T) {
+	d := newIslandTestDispatcher(t)
+
+	// node 2 can not reach node 1, but node 1 reaches node 2: one island
+	addIslandTestNode(d, 1, 0, 0, 150)
+	addIslandTestNode(d, 2, 100, 0, 50)
+
+	islands := d.getIslands()
+	assert.Equal(t, 1, islands.count)
+}
+
+func TestComputeIslands_Invalidation(t *testing.T) {
+	d := newIslandTestDispatcher(t)
+
+	addIslandTestNode(d, 1, 0, 0, 150)
+	node2 := addIslandTestNode(d, 2, 1000, 0, 150)
+	assert.Equal(t, 2, d.getIslands().count)
+
+	oldX, oldY := node2.X, node2.Y
+	node2.X, node2.Y = 100, 0
+	d.spatialIndex.Move(node2, oldX, oldY)
+	assert.Equal(t, 1, d.getIslands().count)
+}
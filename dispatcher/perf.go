@@ -0,0 +1,200 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"sync"
+	"time"
+)
+
+const perfHistogramBuckets = 24
+
+// timeHistogram counts durations in exponential buckets: bucket i covers
+// [2^i, 2^(i+1)) microseconds, with the last bucket unbounded.
+type timeHistogram struct {
+	buckets [perfHistogramBuckets]uint64
+	count   uint64
+	total   time.Duration
+	max     time.Duration
+}
+
+func (h *timeHistogram) Add(d time.Duration) {
+	us := d.Microseconds()
+	i := 0
+	for us >= 2 && i < perfHistogramBuckets-1 {
+		us >>= 1
+		i++
+	}
+
+	h.buckets[i]++
+	h.count++
+	h.total += d
+	if d > h.max {
+		h.max = d
+	}
+}
+
+// percentile returns an upper bound of the given percentile (0..100) in
+// microseconds.
+func (h *timeHistogram) percentile(p float64) int64 {
+	if h.count == 0 {
+		return 0
+	}
+
+	rank := uint64(p / 100 * float64(h.count))
+	var seen uint64
+	for i, cnt := range h.buckets {
+		seen += cnt
+		if seen > rank {
+			return int64(1) << uint(i+1) // bucket upper bound
+		}
+	}
+
+	return h.max.Microseconds()
+}
+
+func (h *timeHistogram) snapshot() PerfPhaseStats {
+	s := PerfPhaseStats{
+		Count: h.count,
+		MaxUs: h.max.Microseconds(),
+		P50Us: h.percentile(50),
+		P90Us: h.percentile(90),
+		P99Us: h.percentile(99),
+	}
+	if h.count > 0 {
+		s.AvgUs = h.total.Microseconds() / int64(h.count)
+	}
+	return s
+}
+
+// PerfPhaseStats summarizes the time spent in one dispatcher phase.
+type PerfPhaseStats struct {
+	Count uint64
+	AvgUs int64
+	P50Us int64
+	P90Us int64
+	P99Us int64
+	MaxUs int64
+}
+
+// PerfStats is a snapshot of the dispatcher performance statistics.
+type PerfStats struct {
+	EventsReceived uint64
+	// events received per second since the previous snapshot
+	EventsPerSec float64
+	// requested and achieved simulating speed (simulated vs real time)
+	RequestedSpeed float64
+	AchievedSpeed  float64
+	// queue depths as of the last dispatcher loop iteration
+	EventChanDepth int
+	PcapChanDepth  int
+	SendQueueDepth int
+	// Recv includes waiting for node replies; Process is one main loop
+	// iteration including speed pacing; Send is dispatching one frame.
+	Recv    PerfPhaseStats
+	Process PerfPhaseStats
+	Send    PerfPhaseStats
+}
+
+// perfStats collects the dispatcher performance statistics. Recording happens
+// on the dispatcher goroutine only; snapshots may be taken from any goroutine.
+type perfStats struct {
+	mu sync.Mutex
+
+	eventsReceived uint64
+	recvHist       timeHistogram
+	processHist    timeHistogram
+	sendHist       timeHistogram
+
+	eventChanDepth int
+	pcapChanDepth  int
+	sendQueueDepth int
+
+	requestedSpeed float64
+	achievedSpeed  float64
+
+	lastSnapshotTime   time.Time
+	lastEventsReceived uint64
+}
+
+func newPerfStats() *perfStats {
+	return &perfStats{
+		lastSnapshotTime: time.Now(),
+	}
+}
+
+func (p *perfStats) recordRecv(count int, d time.Duration) {
+	p.mu.Lock()
+	p.eventsReceived += uint64(count)
+	p.recvHist.Add(d)
+	p.mu.Unlock()
+}
+
+func (p *perfStats) recordSend(d time.Duration) {
+	p.mu.Lock()
+	p.sendHist.Add(d)
+	p.mu.Unlock()
+}
+
+// recordLoop records one main loop iteration together with the current queue
+// depths and achieved speed.
+func (p *perfStats) recordLoop(d time.Duration, eventChanDepth, pcapChanDepth, sendQueueDepth int, requestedSpeed, achievedSpeed float64) {
+	p.mu.Lock()
+	p.processHist.Add(d)
+	p.eventChanDepth = eventChanDepth
+	p.pcapChanDepth = pcapChanDepth
+	p.sendQueueDepth = sendQueueDepth
+	p.requestedSpeed = requestedSpeed
+	p.achievedSpeed = achievedSpeed
+	p.mu.Unlock()
+}
+
+func (p *perfStats) Snapshot() PerfStats {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	now := time.Now()
+	stats := PerfStats{
+		EventsReceived: p.eventsReceived,
+		RequestedSpeed: p.requestedSpeed,
+		AchievedSpeed:  p.achievedSpeed,
+		EventChanDepth: p.eventChanDepth,
+		PcapChanDepth:  p.pcapChanDepth,
+		SendQueueDepth: p.sendQueueDepth,
+		Recv:           p.recvHist.snapshot(),
+		Process:        p.processHist.snapshot(),
+		Send:           p.sendHist.snapshot(),
+	}
+
+	if interval := now.Sub(p.lastSnapshotTime); interval > 0 {
+		stats.EventsPerSec = float64(p.eventsReceived-p.lastEventsReceived) / interval.Seconds()
+	}
+	p.lastSnapshotTime = now
+	p.lastEventsReceived = p.eventsReceived
+
+	return stats
+}
@@ -27,68 +27,45 @@
 package dispatcher
 
 import (
-	"container/heap"
+	"testing"
+	"time"
 
-	. "github.com/openthread/ot-ns/types"
+	"github.com/stretchr/testify/assert"
 )
 
-type sendItem struct {
-	Timestamp uint64
-	NodeId    NodeId
-	Data      []byte
-}
-
-type sendQueue struct {
-	q []*sendItem
-}
-
-func (sq sendQueue) Len() int {
-	return len(sq.q)
-}
-
-func (sq sendQueue) Less(i, j int) bool {
-	return sq.q[i].Timestamp < sq.q[j].Timestamp
-}
-
-func (sq sendQueue) Swap(i, j int) {
-	sq.q[i], sq.q[j] = sq.q[j], sq.q[i]
-}
-
-func (sq *sendQueue) Push(x interface{}) {
-	sq.q = append(sq.q, x.(*sendItem))
-}
-
-func (sq *sendQueue) Pop() (elem interface{}) {
-	eqlen := len(sq.q)
-	elem = sq.q[eqlen-1]
-	sq.q = sq.q[:eqlen-1]
-	return
-}
-
-func (sq sendQueue) NextTimestamp() uint64 {
-	if len(sq.q) > 0 {
-		return sq.q[0].Timestamp
-	} else {
-		return Ever
+func TestTimeHistogram(t *testing.T) {
+	h := &timeHistogram{}
+	for i := 0; i < 100; i++ {
+		h.Add(time.Microsecond * 10)
 	}
-}
+	h.Add(time.Millisecond * 10)
 
-func (sq *sendQueue) Add(timestamp uint64, id NodeId, data []byte) {
-	heap.Push(sq, &sendItem{
-		Timestamp: timestamp,
-		NodeId:    id,
-		Data:      data,
-	})
+	assert.Equal(t, uint64(101), h.count)
+	assert.Equal(t, time.Millisecond*10, h.max)
+	assert.True(t, h.percentile(50) >= 10 && h.percentile(50) <= 16)
+	assert.True(t, h.percentile(99) >= 10)
 }
 
-func (sq *sendQueue) PopNext() *sendItem {
-	return heap.Pop(sq).(*sendItem)
-}
+func TestPerfStatsSnapshot(t *testing.T) {
+	p := newPerfStats()
+	p.recordRecv(10, time.Millisecond)
+	p.recordSend(time.Microsecond * 100)
+	p.recordLoop(time.Microsecond*200, 1, 2, 3, 4, 3.5)
 
-func newSendQueue() *sendQueue {
-	sq := &sendQueue{
-		q: []*sendItem{},
-	}
-	heap.Init(sq)
-	return sq
+	stats := p.Snapshot()
+	assert.Equal(t, uint64(10), stats.EventsReceived)
+	assert.True(t, stats.EventsPerSec > 0)
+	assert.Equal(t, 1, stats.EventChanDepth)
+	assert.Equal(t, 2, stats.PcapChanDepth)
+	assert.Equal(t, 3, stats.SendQueueDepth)
+	assert.Equal(t, float64(4), stats.RequestedSpeed)
+	assert.Equal(t, 3.5, stats.AchievedSpeed)
+	assert.Equal(t, uint64(1), stats.Recv.Count)
+	assert.Equal(t, uint64(1), stats.Send.Count)
+	assert.Equal(t, uint64(1), stats.Process.Count)
+
+	// the second snapshot only counts events received since the first
+	stats = p.Snapshot()
+	assert.Equal(t, uint64(10), stats.EventsReceived)
+	assert.True(t, stats.EventsPerSec == 0)
 }
@@ -0,0 +1,252 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math"
+	"math/rand"
+
+	"github.com/simonlingoogle/go-simplelogger"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+// Selectable radio models (see Config.RadioModel).
+const (
+	RadioModelDisc     = "disc"
+	RadioModelPathLoss = "pathloss"
+)
+
+// RssiInvalid marks an unusable link (also the OT_RADIO_RSSI_INVALID value).
+const RssiInvalid = 127
+
+// Parameters of the log-distance path-loss model with log-normal shadowing:
+//
+//	PL(d) = PL(d0) + 10 * n * log10(d/d0) + Xσ
+//	RSSI  = Ptx - PL(d)
+//
+// A link is usable when its RSSI is at or above the receive sensitivity. The
+// shadowing term Xσ is drawn once per node pair from a deterministic seed, so
+// simulations stay reproducible and a link keeps its character when other
+// nodes move.
+const (
+	pathLossTxPowerDbm       = 0.0
+	pathLossRxSensitivityDbm = -100.0
+	pathLossRefDistance      = 1.0  // d0, in position units
+	pathLossRefLossDb        = 40.0 // PL(d0)
+	pathLossExponent         = 3.0  // n
+	pathLossShadowSigmaDb    = 4.0  // σ, clamped to ±3σ per link
+)
+
+// radioModel decides whether a transmitted frame reaches a destination node.
+// CheckReachable and LinkRssi are called from the frame dispatch hot path and
+// must not do per-call geometry math beyond integer comparisons and lookups.
+type radioModel interface {
+	// CheckReachable reports whether a frame from src is received by dst;
+	// src and dst are distinct.
+	CheckReachable(src *Node, dst *Node) bool
+	// LinkRssi returns the received signal strength (dBm) at dst for a frame
+	// from src, or RssiInvalid when the link is unusable.
+	LinkRssi(src *Node, dst *Node) float64
+	// neighborRadius bounds the distance within which src can reach any node;
+	// it is used as the spatial index query radius for broadcasts.
+	neighborRadius(src *Node) int
+
+	onNodeAdded(node *Node)
+	onNodeDeleted(node *Node)
+	onNodePosChanged(node *Node)
+}
+
+func newRadioModel(name string, d *Dispatcher) radioModel {
+	switch name {
+	case "", RadioModelDisc:
+		return &discRadioModel{}
+	case RadioModelPathLoss:
+		return newPathLossRadioModel(d)
+	default:
+		simplelogger.Fatalf("unknown radio model: %s", name)
+		return nil
+	}
+}
+
+// discRadioModel is the classic hard-disc model: a frame reaches every node
+// within the sender's radio range, with no per-link variation. Reachability is
+// decided on squared integer distances, equivalent to the former truncated
+// GetDistanceTo comparison but without the square root.
+type discRadioModel struct{}
+
+func (m *discRadioModel) CheckReachable(src *Node, dst *Node) bool {
+	dx := dst.X - src.X
+	dy := dst.Y - src.Y
+	// int(sqrt(d2)) <= r is equivalent to d2 < (r+1)^2
+	r2 := (src.radioRange + 1) * (src.radioRange + 1)
+	return dx*dx+dy*dy < r2
+}
+
+func (m *discRadioModel) LinkRssi(src *Node, dst *Node) float64 {
+	if !m.CheckReachable(src, dst) {
+		return RssiInvalid
+	}
+	// nominal linear falloff from -40 dBm down to the sensitivity limit at
+	// the range boundary; only used for reporting, not for reachability
+	dist := float64(src.GetDistanceTo(dst))
+	return -40 + (pathLossRxSensitivityDbm+40)*dist/float64(src.radioRange)
+}
+
+func (m *discRadioModel) neighborRadius(src *Node) int {
+	return src.radioRange
+}
+
+func (m *discRadioModel) onNodeAdded(node *Node)      {}
+func (m *discRadioModel) onNodeDeleted(node *Node)    {}
+func (m *discRadioModel) onNodePosChanged(node *Node) {}
+
+// linkKey identifies an unordered node pair; a < b.
+type linkKey struct {
+	a, b NodeId
+}
+
+func makeLinkKey(id1, id2 NodeId) linkKey {
+	if id1 < id2 {
+		return linkKey{id1, id2}
+	}
+	return linkKey{id2, id1}
+}
+
+type linkState struct {
+	rssi      float64
+	reachable bool
+}
+
+// pathLossRadioModel implements the log-distance path-loss model backed by a
+// per-pair link cache. The cache is maintained incrementally: adding, deleting
+// or moving a node only touches the links of that node, and per-frame delivery
+// decisions are a single map lookup.
+type pathLossRadioModel struct {
+	d         *Dispatcher
+	links     map[linkKey]linkState
+	maxRadius int
+}
+
+func newPathLossRadioModel(d *Dispatcher) *pathLossRadioModel {
+	// the maximum usable distance, given the best-case shadowing of +3σ;
+	// beyond it no link can reach the receive sensitivity
+	exp := (pathLossTxPowerDbm - pathLossRxSensitivityDbm - pathLossRefLossDb +
+		3*pathLossShadowSigmaDb) / (10 * pathLossExponent)
+	maxRadius := int(math.Ceil(pathLossRefDistance * math.Pow(10, exp)))
+
+	simplelogger.Infof("path-loss radio model: n=%v σ=%vdB, max link distance %v", pathLossExponent,
+		pathLossShadowSigmaDb, maxRadius)
+
+	return &pathLossRadioModel{
+		d:         d,
+		links:     map[linkKey]linkState{},
+		maxRadius: maxRadius,
+	}
+}
+
+// linkShadowDb returns the shadowing term of a node pair, drawn from a seed
+// derived from the pair so that it is stable and reproducible.
+func linkShadowDb(key linkKey) float64 {
+	seed := int64(key.a)*1000003 + int64(key.b)
+	shadow := rand.New(rand.NewSource(seed)).NormFloat64() * pathLossShadowSigmaDb
+	if shadow > 3*pathLossShadowSigmaDb {
+		shadow = 3 * pathLossShadowSigmaDb
+	} else if shadow < -3*pathLossShadowSigmaDb {
+		shadow = -3 * pathLossShadowSigmaDb
+	}
+	return shadow
+}
+
+func (m *pathLossRadioModel) computeLink(a *Node, b *Node) linkState {
+	key := makeLinkKey(a.Id, b.Id)
+
+	dx := float64(b.X - a.X)
+	dy := float64(b.Y - a.Y)
+	dist := math.Sqrt(dx*dx + dy*dy)
+	if dist < pathLossRefDistance {
+		dist = pathLossRefDistance
+	}
+
+	pl := pathLossRefLossDb + 10*pathLossExponent*math.Log10(dist/pathLossRefDistance) - linkShadowDb(key)
+	rssi := pathLossTxPowerDbm - pl
+
+	return linkState{
+		rssi:      rssi,
+		reachable: rssi >= pathLossRxSensitivityDbm,
+	}
+}
+
+func (m *pathLossRadioModel) getLink(src *Node, dst *Node) linkState {
+	key := makeLinkKey(src.Id, dst.Id)
+	st, ok := m.links[key]
+	if !ok {
+		st = m.computeLink(src, dst)
+		m.links[key] = st
+	}
+	return st
+}
+
+func (m *pathLossRadioModel) CheckReachable(src *Node, dst *Node) bool {
+	return m.getLink(src, dst).reachable
+}
+
+func (m *pathLossRadioModel) LinkRssi(src *Node, dst *Node) float64 {
+	st := m.getLink(src, dst)
+	if !st.reachable {
+		return RssiInvalid
+	}
+	return st.rssi
+}
+
+func (m *pathLossRadioModel) neighborRadius(src *Node) int {
+	return m.maxRadius
+}
+
+func (m *pathLossRadioModel) onNodeAdded(node *Node) {
+	for _, other := range m.d.nodes {
+		if other != node {
+			m.links[makeLinkKey(node.Id, other.Id)] = m.computeLink(node, other)
+		}
+	}
+}
+
+func (m *pathLossRadioModel) onNodeDeleted(node *Node) {
+	for key := range m.links {
+		if key.a == node.Id || key.b == node.Id {
+			delete(m.links, key)
+		}
+	}
+}
+
+func (m *pathLossRadioModel) onNodePosChanged(node *Node) {
+	for _, other := range m.d.nodes {
+		if other != node {
+			m.links[makeLinkKey(node.Id, other.Id)] = m.computeLink(node, other)
+		}
+	}
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math"
+	"math/rand"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+func TestDiscRadioModel_MatchesTruncatedDistance(t *testing.T) {
+	m := &discRadioModel{}
+	r := rand.New(rand.NewSource(1))
+
+	src := &Node{Id: 1, radioRange: 150}
+	for i := 0; i < 1000; i++ {
+		dst := &Node{Id: 2, X: r.Intn(400) - 200, Y: r.Intn(400) - 200}
+		expected := src.GetDistanceTo(dst) <= src.radioRange
+		assert.Equal(t, expected, m.CheckReachable(src, dst), "at (%d,%d)", dst.X, dst.Y)
+	}
+
+	// exact boundary: distance 150 reachable, 151 not
+	assert.True(t, m.CheckReachable(src, &Node{Id: 2, X: 150}))
+	assert.False(t, m.CheckReachable(src, &Node{Id: 2, X: 151}))
+}
+
+func newPathLossTestModel() (*Dispatcher, *pathLossRadioModel) {
+	d := &Dispatcher{nodes: map[NodeId]*Node{}}
+	m := newPathLossRadioModel(d)
+	return d, m
+}
+
+func (m *pathLossRadioModel) addTestNode(d *Dispatcher, id NodeId, x, y int) *Node {
+	node := &Node{Id: id, X: x, Y: y}
+	d.nodes[id] = node
+	m.onNodeAdded(node)
+	return node
+}
+
+func TestPathLossRadioModel_Basic(t *testing.T) {
+	d, m := newPathLossTestModel()
+	n1 := m.addTestNode(d, 1, 0, 0)
+	n2 := m.addTestNode(d, 2, 10, 0)
+
+	// close links are always reachable, far beyond maxRadius never
+	assert.True(t, m.CheckReachable(n1, n2))
+	assert.True(t, m.LinkRssi(n1, n2) >= pathLossRxSensitivityDbm)
+
+	n3 := m.addTestNode(d, 3, 10*m.maxRadius, 0)
+	assert.False(t, m.CheckReachable(n1, n3))
+	assert.Equal(t, float64(RssiInvalid), m.LinkRssi(n1, n3))
+
+	// links are symmetric
+	assert.Equal(t, m.LinkRssi(n1, n2), m.LinkRssi(n2, n1))
+}
+
+func TestPathLossRadioModel_Deterministic(t *testing.T) {
+	_, m1 := newPathLossTestModel()
+	_, m2 := newPathLossTestModel()
+
+	a1 := &Node{Id: 1, X: 0, Y: 0}
+	b1 := &Node{Id: 2, X: 120, Y: 50}
+	assert.Equal(t, m1.computeLink(a1, b1), m2.computeLink(a1, b1))
+
+	// the shadowing term of a pair does not depend on computation order or
+	// on other nodes
+	assert.Equal(t, linkShadowDb(makeLinkKey(1, 2)), linkShadowDb(makeLinkKey(2, 1)))
+	assert.True(t, math.Abs(linkShadowDb(makeLinkKey(1, 2))) <= 3*pathLossShadowSigmaDb)
+}
+
+func TestPathLossRadioModel_IncrementalUpdates(t *testing.T) {
+	d, m := newPathLossTestModel()
+	n1 := m.addTestNode(d, 1, 0, 0)
+	n2 := m.addTestNode(d, 2, 10, 0)
+	assert.True(t, m.CheckReachable(n1, n2))
+
+	// moving a node beyond the maximum link distance updates its cached links
+	n2.X = 10 * m.maxRadius
+	m.onNodePosChanged(n2)
+	assert.False(t, m.CheckReachable(n1, n2))
+
+	n2.X = 10
+	m.onNodePosChanged(n2)
+	assert.True(t, m.CheckReachable(n1, n2))
+
+	// deleting a node drops all of its links from the cache
+	delete(d.nodes, n2.Id)
+	m.onNodeDeleted(n2)
+	assert.Equal(t, 0, len(m.links))
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+// spatialIndexCellSize is the edge length (in position units) of one grid cell.
+// It should be in the same order of magnitude as typical radio ranges so that a
+// range query only touches a few cells.
+const spatialIndexCellSize = 100
+
+type spatialCell struct {
+	cx, cy int
+}
+
+// spatialIndex is a uniform grid over node positions that answers "which nodes
+// are within radius r of (x, y)" without iterating all nodes.
+type spatialIndex struct {
+	cells map[spatialCell]map[*Node]struct{}
+	// generation increases on every insert/remove/move and is used by nodes to
+	// validate their cached neighbor lists.
+	generation uint64
+}
+
+func newSpatialIndex() *spatialIndex {
+	return &spatialIndex{
+		cells: map[spatialCell]map[*Node]struct{}{},
+	}
+}
+
+func cellOf(x, y int) spatialCell {
+	return spatialCell{floorDiv(x, spatialIndexCellSize), floorDiv(y, spatialIndexCellSize)}
+}
+
+func floorDiv(a, b int) int {
+	q := a / b
+	if a%b != 0 && (a < 0) != (b < 0) {
+		q--
+	}
+	return q
+}
+
+func (si *spatialIndex) Insert(node *Node) {
+	c := cellOf(node.X, node.Y)
+	nodes := si.cells[c]
+	if nodes == nil {
+		nodes = map[*Node]struct{}{}
+		si.cells[c] = nodes
+	}
+	nodes[node] = struct{}{}
+	si.generation++
+}
+
+func (si *spatialIndex) Remove(node *Node) {
+	c := cellOf(node.X, node.Y)
+	nodes := si.cells[c]
+	simplelogger.AssertTrue(nodes != nil)
+	delete(nodes, node)
+	if len(nodes) == 0 {
+		delete(si.cells, c)
+	}
+	si.generation++
+}
+
+// Move updates the node's cell after its position already changed from (oldX, oldY).
+func (si *spatialIndex) Move(node *Node, oldX, oldY int) {
+	oldCell := cellOf(oldX, oldY)
+	newCell := cellOf(node.X, node.Y)
+	if oldCell != newCell {
+		nodes := si.cells[oldCell]
+		simplelogger.AssertTrue(nodes != nil)
+		delete(nodes, node)
+		if len(nodes) == 0 {
+			delete(si.cells, oldCell)
+		}
+
+		newNodes := si.cells[newCell]
+		if newNodes == nil {
+			newNodes = map[*Node]struct{}{}
+			si.cells[newCell] = newNodes
+		}
+		newNodes[node] = struct{}{}
+	}
+	// positions within one cell still invalidate cached neighbor lists because
+	// distances to nodes near the radio range boundary may have changed
+	si.generation++
+}
+
+// Query visits all nodes within distance radius of (x, y).
+func (si *spatialIndex) Query(x, y, radius int, visit func(*Node)) {
+	simplelogger.AssertTrue(radius >= 0)
+
+	minCell := cellOf(x-radius, y-radius)
+	maxCell := cellOf(x+radius, y+radius)
+	// Node.GetDistanceTo truncates the Euclidean distance to an int, so a node
+	// is within radius iff dx^2+dy^2 < (radius+1)^2.
+	r2 := (radius + 1) * (radius + 1)
+
+	for cx := minCell.cx; cx <= maxCell.cx; cx++ {
+		for cy := minCell.cy; cy <= maxCell.cy; cy++ {
+			for node := range si.cells[spatialCell{cx, cy}] {
+				dx := node.X - x
+				dy := node.Y - y
+				if dx*dx+dy*dy < r2 {
+					visit(node)
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math"
+	"math/rand"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+)
+
+func queryNodeSet(si *spatialIndex, x, y, radius int) map[*Node]struct{} {
+	found := map[*Node]struct{}{}
+	si.Query(x, y, radius, func(node *Node) {
+		found[node] = struct{}{}
+	})
+	return found
+}
+
+func TestSpatialIndex_Query(t *testing.T) {
+	si := newSpatialIndex()
+	n1 := &Node{Id: 1, X: 0, Y: 0}
+	n2 := &Node{Id: 2, X: 150, Y: 0}
+	n3 := &Node{Id: 3, X: 0, Y: 151}
+	si.Insert(n1)
+	si.Insert(n2)
+	si.Insert(n3)
+
+	found := queryNodeSet(si, 0, 0, 150)
+	assert.Equal(t, 2, len(found))
+	assert.Contains(t, found, n1)
+	assert.Contains(t, found, n2)
+
+	found = queryNodeSet(si, 0, 0, 151)
+	assert.Equal(t, 3, len(found))
+}
+
+func TestSpatialIndex_MoveRemove(t *testing.T) {
+	si := newSpatialIndex()
+	n1 := &Node{Id: 1, X: 0, Y: 0}
+	si.Insert(n1)
+	gen := si.generation
+
+	oldX, oldY := n1.X, n1.Y
+	n1.X, n1.Y = 1000, 1000
+	si.Move(n1, oldX, oldY)
+	assert.True(t, si.generation > gen)
+	assert.Equal(t, 0, len(queryNodeSet(si, 0, 0, 100)))
+	assert.Equal(t, 1, len(queryNodeSet(si, 1000, 1000, 100)))
+
+	si.Remove(n1)
+	assert.Equal(t, 0, len(queryNodeSet(si, 1000, 1000, 100)))
+}
+
+func TestSpatialIndex_QueryMatchesDistance(t *testing.T) {
+	si := newSpatialIndex()
+	var nodes []*Node
+	r := rand.New(rand.NewSource(1))
+	for i := 1; i <= 500; i++ {
+		node := &Node{Id: i, X: r.Intn(1000) - 500, Y: r.Intn(1000) - 500}
+		si.Insert(node)
+		nodes = append(nodes, node)
+	}
+
+	for _, radius := range []int{0, 50, 150, 400} {
+		for _, src := range nodes[:20] {
+			found := queryNodeSet(si, src.X, src.Y, radius)
+			for _, dst := range nodes {
+				dx := float64(dst.X - src.X)
+				dy := float64(dst.Y - src.Y)
+				inRange := int(math.Sqrt(dx*dx+dy*dy)) <= radius
+				_, ok := found[dst]
+				assert.Equal(t, inRange, ok)
+			}
+		}
+	}
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"encoding/binary"
+
+	. "github.com/openthread/ot-ns/types"
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+// Binary status pushes (eventTypeStatusPushBinary) carry a version byte
+// followed by a sequence of TLVs (type byte, length byte, value), with
+// fixed-width little-endian values for the high-frequency numeric keys of the
+// textual status push protocol. A node advertises support simply by using the
+// binary event type; the textual format remains fully supported as fallback,
+// and composite or rare statuses are carried verbatim in statusTlvText TLVs.
+const statusPushBinaryVersion = 1
+
+const (
+	statusTlvRole          = 1  // u8, device role
+	statusTlvRloc16        = 2  // u16
+	statusTlvPartitionId   = 3  // u32
+	statusTlvExtAddr       = 4  // u64
+	statusTlvParent        = 5  // u64 extaddr
+	statusTlvRouterAdded   = 6  // u64 extaddr
+	statusTlvRouterRemoved = 7  // u64 extaddr
+	statusTlvChildAdded    = 8  // u64 extaddr
+	statusTlvChildRemoved  = 9  // u64 extaddr
+	statusTlvJoinerState   = 10 // u8
+	statusTlvText          = 11 // "key=value" string, parsed by the textual path
+)
+
+func (d *Dispatcher) handleStatusPushBinary(srcid NodeId, data []byte) {
+	srcnode := d.nodes[srcid]
+	if srcnode == nil {
+		simplelogger.Warnf("node not found: %d", srcid)
+		return
+	}
+
+	if len(data) < 1 || data[0] != statusPushBinaryVersion {
+		simplelogger.Warnf("unsupported binary status push version from node %d", srcid)
+		return
+	}
+
+	pos := 1
+	for pos+2 <= len(data) {
+		tlvType := data[pos]
+		tlvLen := int(data[pos+1])
+		pos += 2
+		if pos+tlvLen > len(data) {
+			simplelogger.Warnf("truncated binary status push from node %d", srcid)
+			return
+		}
+		value := data[pos : pos+tlvLen]
+		pos += tlvLen
+
+		if !d.handleStatusTlv(srcid, srcnode, tlvType, value) {
+			simplelogger.Warnf("invalid status TLV %d (len %d) from node %d", tlvType, tlvLen, srcid)
+		}
+	}
+}
+
+func (d *Dispatcher) handleStatusTlv(srcid NodeId, srcnode *Node, tlvType uint8, value []byte) bool {
+	switch tlvType {
+	case statusTlvRole:
+		if len(value) != 1 {
+			return false
+		}
+		d.setNodeRole(srcid, OtDeviceRole(value[0]))
+	case statusTlvRloc16:
+		if len(value) != 2 {
+			return false
+		}
+		d.setNodeRloc16(srcid, binary.LittleEndian.Uint16(value))
+	case statusTlvPartitionId:
+		if len(value) != 4 {
+			return false
+		}
+		parid := binary.LittleEndian.Uint32(value)
+		d.topology.setNodePartition(srcnode, parid)
+		d.vis.SetNodePartitionId(srcid, parid)
+	case statusTlvExtAddr:
+		if len(value) != 8 {
+			return false
+		}
+		srcnode.onStatusPushExtAddr(binary.LittleEndian.Uint64(value))
+	case statusTlvParent:
+		if len(value) != 8 {
+			return false
+		}
+		extaddr := binary.LittleEndian.Uint64(value)
+		d.topology.setParent(srcid, extaddr)
+		d.vis.SetParent(srcid, extaddr)
+	case statusTlvRouterAdded:
+		if len(value) != 8 {
+			return false
+		}
+		extaddr := binary.LittleEndian.Uint64(value)
+		d.topology.addRouterLink(srcid, extaddr)
+		if d.visOptions.RouterTable {
+			d.vis.AddRouterTable(srcid, extaddr)
+		}
+	case statusTlvRouterRemoved:
+		if len(value) != 8 {
+			return false
+		}
+		extaddr := binary.LittleEndian.Uint64(value)
+		d.topology.removeRouterLink(srcid, extaddr)
+		if d.visOptions.RouterTable {
+			d.vis.RemoveRouterTable(srcid, extaddr)
+		}
+	case statusTlvChildAdded:
+		if len(value) != 8 {
+			return false
+		}
+		extaddr := binary.LittleEndian.Uint64(value)
+		d.topology.addChild(srcid, extaddr)
+		if d.visOptions.ChildTable {
+			d.vis.AddChildTable(srcid, extaddr)
+		}
+	case statusTlvChildRemoved:
+		if len(value) != 8 {
+			return false
+		}
+		extaddr := binary.LittleEndian.Uint64(value)
+		d.topology.removeChild(srcid, extaddr)
+		if d.visOptions.ChildTable {
+			d.vis.RemoveChildTable(srcid, extaddr)
+		}
+	case statusTlvJoinerState:
+		if len(value) != 1 {
+			return false
+		}
+		srcnode.onJoinerState(OtJoinerState(value[0]))
+	case statusTlvText:
+		d.handleStatusPush(srcid, string(value))
+	default:
+		return false
+	}
+
+	return true
+}
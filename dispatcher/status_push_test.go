@@ -0,0 +1,111 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"encoding/binary"
+	"testing"
+
+	"github.com/openthread/ot-ns/threadconst"
+	. "github.com/openthread/ot-ns/types"
+	"github.com/openthread/ot-ns/visualize"
+	"github.com/stretchr/testify/assert"
+)
+
+func newStatusPushTestDispatcher() (*Dispatcher, *Node) {
+	d := &Dispatcher{
+		nodes:        map[NodeId]*Node{},
+		spatialIndex: newSpatialIndex(),
+		rloc16Map:    rloc16Map{},
+		extaddrMap:   map[uint64]*Node{},
+		vis:          visualize.NewNopVisualizer(),
+		visOptions:   defaultVisualizationOptions(),
+	}
+	node := &Node{D: d, Id: 1, ExtAddr: InvalidExtAddr, Rloc16: threadconst.InvalidRloc16}
+	d.nodes[1] = node
+	return d, node
+}
+
+func appendStatusTlv(data []byte, tlvType uint8, value []byte) []byte {
+	data = append(data, tlvType, uint8(len(value)))
+	return append(data, value...)
+}
+
+func TestHandleStatusPushBinary(t *testing.T) {
+	d, node := newStatusPushTestDispatcher()
+
+	data := []byte{statusPushBinaryVersion}
+	data = appendStatusTlv(data, statusTlvRole, []byte{uint8(OtDeviceRoleLeader)})
+	rloc := make([]byte, 2)
+	binary.LittleEndian.PutUint16(rloc, 0xec00)
+	data = appendStatusTlv(data, statusTlvRloc16, rloc)
+	parid := make([]byte, 4)
+	binary.LittleEndian.PutUint32(parid, 0x12345678)
+	data = appendStatusTlv(data, statusTlvPartitionId, parid)
+	extaddr := make([]byte, 8)
+	binary.LittleEndian.PutUint64(extaddr, 0x1122334455667788)
+	data = appendStatusTlv(data, statusTlvExtAddr, extaddr)
+
+	d.handleStatusPushBinary(1, data)
+
+	assert.Equal(t, OtDeviceRoleLeader, node.Role)
+	assert.Equal(t, uint16(0xec00), node.Rloc16)
+	assert.Equal(t, uint32(0x12345678), node.PartitionId)
+	assert.Equal(t, uint64(0x1122334455667788), node.ExtAddr)
+	assert.True(t, d.rloc16Map.Contains(0xec00, node))
+	assert.True(t, d.extaddrMap[node.ExtAddr] == node)
+}
+
+func TestHandleStatusPushBinary_TextFallback(t *testing.T) {
+	d, node := newStatusPushTestDispatcher()
+
+	data := []byte{statusPushBinaryVersion}
+	data = appendStatusTlv(data, statusTlvText, []byte("role=4"))
+	d.handleStatusPushBinary(1, data)
+	assert.Equal(t, OtDeviceRoleLeader, node.Role)
+}
+
+func TestHandleStatusPushBinary_Malformed(t *testing.T) {
+	d, node := newStatusPushTestDispatcher()
+
+	// wrong version: ignored entirely
+	data := []byte{statusPushBinaryVersion + 1}
+	data = appendStatusTlv(data, statusTlvRole, []byte{uint8(OtDeviceRoleLeader)})
+	d.handleStatusPushBinary(1, data)
+	assert.Equal(t, OtDeviceRoleDisabled, node.Role)
+
+	// truncated TLV: parsing stops without panic
+	data = []byte{statusPushBinaryVersion, statusTlvRloc16, 2, 0xab}
+	d.handleStatusPushBinary(1, data)
+	assert.Equal(t, threadconst.InvalidRloc16, node.Rloc16)
+
+	// bad length for the type
+	data = []byte{statusPushBinaryVersion}
+	data = appendStatusTlv(data, statusTlvRole, []byte{1, 2})
+	d.handleStatusPushBinary(1, data)
+	assert.Equal(t, OtDeviceRoleDisabled, node.Role)
+}
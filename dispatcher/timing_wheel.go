@@ -0,0 +1,484 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math/bits"
+	"sync"
+
+	. "github.com/openthread/ot-ns/types"
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+const (
+	wheelBits      = 8
+	wheelSlotCount = 1 << wheelBits
+	wheelSlotMask  = wheelSlotCount - 1
+	// wheelLevels gives the wheel a horizon of 2^48 us (~8.9 simulated years),
+	// far beyond the largest alarm delay nodes may request.
+	wheelLevels = 6
+)
+
+type alarmEvent struct {
+	NodeId    NodeId
+	Timestamp uint64 // timestamp of next alarm, Ever while no alarm is set
+}
+
+// failureEvent is the pending failure-control transition (fail or recover) of
+// a node; only nodes with a failure time configured have one. Like alarms,
+// stale wheel entries are invalidated lazily via the Timestamp.
+type failureEvent struct {
+	NodeId    NodeId
+	Timestamp uint64 // timestamp of the next transition, Ever while none is due
+}
+
+type sendItem struct {
+	Timestamp uint64
+	NodeId    NodeId
+	Data      []byte
+	evt       *event // pooled event backing Data, recycled after dispatch
+}
+
+// sendItemPool recycles sendItem structs, which are allocated once per
+// received radio frame on the dispatch hot path (see releaseSendItem).
+var sendItemPool = sync.Pool{
+	New: func() interface{} {
+		return &sendItem{}
+	},
+}
+
+func getSendItem() *sendItem {
+	return sendItemPool.Get().(*sendItem)
+}
+
+func putSendItem(it *sendItem) {
+	*it = sendItem{}
+	sendItemPool.Put(it)
+}
+
+// schedItem is one due scheduler entry: the alarm of a node (Send == nil), a
+// queued frame delivery, or a failure-control transition (Fail == true).
+type schedItem struct {
+	Timestamp uint64
+	NodeId    NodeId
+	Send      *sendItem
+	Fail      bool
+}
+
+// wheelEntry is one scheduled occurrence inside the timing wheel. Alarm
+// entries are invalidated lazily: an entry is live only while the node's
+// alarmEvent still carries the timestamp it was scheduled with; stale entries
+// are dropped whenever a scan encounters them.
+type wheelEntry struct {
+	timestamp uint64
+	alarm     *alarmEvent   // nil unless this is an alarm entry
+	send      *sendItem     // nil unless this is a send entry
+	fail      *failureEvent // nil unless this is a failure-control entry
+}
+
+func (e *wheelEntry) live() bool {
+	switch {
+	case e.send != nil:
+		return true
+	case e.alarm != nil:
+		return e.alarm.Timestamp == e.timestamp
+	default:
+		return e.fail.Timestamp == e.timestamp
+	}
+}
+
+// timingWheel is a hierarchical timing wheel over microsecond timestamps.
+// Level l covers timestamps within 256^(l+1) us of the cursor in slots of
+// 256^l us each, so scheduling appends to a small slice instead of sifting a
+// heap. Per-level occupancy bitmaps let scans for the next timestamp skip
+// empty slots with a few word operations. The cursor only advances when an
+// entry is popped, which keeps it at or below every live timestamp and every
+// timestamp that can still be scheduled.
+type timingWheel struct {
+	cursor   uint64
+	count    int // live entries; stale alarm entries are discounted eagerly
+	slots    [wheelLevels][wheelSlotCount][]wheelEntry
+	occupied [wheelLevels][wheelSlotCount / 64]uint64
+	overflow []wheelEntry // entries beyond the last level's horizon
+
+	cachedMin   uint64
+	cachedLevel int // wheelLevels denotes the overflow list
+	cachedIdx   int
+	cacheValid  bool
+}
+
+func (w *timingWheel) schedule(e wheelEntry) {
+	w.count++
+	if w.cacheValid && e.timestamp <= w.cachedMin {
+		w.cacheValid = false
+	}
+
+	at := e.timestamp
+	if at < w.cursor {
+		// can not happen for the dispatcher's timestamps; keep the entry
+		// findable by placing it in the cursor slot
+		at = w.cursor
+	}
+
+	dt := at - w.cursor
+	for level := 0; level < wheelLevels; level++ {
+		shift := uint(level) * wheelBits
+		if dt>>shift < wheelSlotCount {
+			idx := int(at>>shift) & wheelSlotMask
+			w.slots[level][idx] = append(w.slots[level][idx], e)
+			w.occupied[level][idx>>6] |= 1 << uint(idx&63)
+			return
+		}
+	}
+	w.overflow = append(w.overflow, e)
+}
+
+// invalidate accounts for an entry with the given timestamp turning stale.
+func (w *timingWheel) invalidate(timestamp uint64) {
+	w.count--
+	if w.cacheValid && timestamp <= w.cachedMin {
+		w.cacheValid = false
+	}
+}
+
+func (w *timingWheel) nextTimestamp() uint64 {
+	if !w.cacheValid {
+		w.findMin()
+		w.cacheValid = true
+	}
+	return w.cachedMin
+}
+
+// findMin locates the earliest live entry. Per level only the first occupied
+// slot in cyclic order from the cursor can hold that level's earliest entry,
+// so at most one slot per level (plus the overflow list) is inspected. At
+// equal timestamps a slot holding an alarm wins, preserving the
+// alarms-before-sends dispatch order of the former two-heap scheduler.
+func (w *timingWheel) findMin() {
+	bestTs := Ever
+	bestAlarm := false
+	w.cachedLevel = -1
+	w.cachedIdx = 0
+
+	for level := 0; level < wheelLevels; level++ {
+		idx, ok := w.firstOccupied(level)
+		if !ok {
+			continue
+		}
+		ts, hasAlarm := slotMin(w.slots[level][idx])
+		if ts < bestTs || (ts == bestTs && hasAlarm && !bestAlarm) {
+			bestTs, bestAlarm = ts, hasAlarm
+			w.cachedLevel, w.cachedIdx = level, idx
+		}
+	}
+
+	if len(w.overflow) > 0 {
+		w.overflow = compactLive(w.overflow)
+		if len(w.overflow) > 0 {
+			ts, hasAlarm := slotMin(w.overflow)
+			if ts < bestTs || (ts == bestTs && hasAlarm && !bestAlarm) {
+				bestTs = ts
+				w.cachedLevel = wheelLevels
+			}
+		}
+	}
+
+	w.cachedMin = bestTs
+}
+
+// firstOccupied returns the first slot of the level, in cyclic order from the
+// cursor, that holds a live entry. Slots found to hold only stale entries are
+// emptied along the way.
+func (w *timingWheel) firstOccupied(level int) (int, bool) {
+	shift := uint(level) * wheelBits
+	curIdx := int(w.cursor>>shift) & wheelSlotMask
+
+	for off := 0; off < wheelSlotCount; {
+		idx := (curIdx + off) & wheelSlotMask
+		word := w.occupied[level][idx>>6] >> uint(idx&63)
+		if word == 0 {
+			off += 64 - idx&63
+			continue
+		}
+		off += bits.TrailingZeros64(word)
+		if off >= wheelSlotCount {
+			break
+		}
+		idx = (curIdx + off) & wheelSlotMask
+
+		slot := compactLive(w.slots[level][idx])
+		w.slots[level][idx] = slot
+		if len(slot) == 0 {
+			w.occupied[level][idx>>6] &^= 1 << uint(idx&63)
+			off++
+			continue
+		}
+		return idx, true
+	}
+
+	return 0, false
+}
+
+// pop removes and returns the earliest live entry, preferring alarm entries
+// at equal timestamps. The wheel must not be empty.
+func (w *timingWheel) pop() wheelEntry {
+	simplelogger.AssertTrue(w.count > 0)
+	ts := w.nextTimestamp()
+
+	var slot *[]wheelEntry
+	if w.cachedLevel == wheelLevels {
+		slot = &w.overflow
+	} else {
+		slot = &w.slots[w.cachedLevel][w.cachedIdx]
+	}
+
+	entries := *slot
+	pick := -1
+	for i := range entries {
+		if entries[i].timestamp != ts {
+			continue
+		}
+		if entries[i].alarm != nil {
+			pick = i
+			break
+		}
+		if pick < 0 {
+			pick = i
+		}
+	}
+	simplelogger.AssertTrue(pick >= 0)
+	e := entries[pick]
+
+	last := len(entries) - 1
+	entries[pick] = entries[last]
+	entries[last] = wheelEntry{}
+	*slot = entries[:last]
+	w.count--
+	if w.cursor < ts {
+		w.cursor = ts
+	}
+	w.cacheValid = false
+
+	if w.cachedLevel == wheelLevels {
+		return e
+	}
+
+	if len(*slot) == 0 {
+		w.occupied[w.cachedLevel][w.cachedIdx>>6] &^= 1 << uint(w.cachedIdx&63)
+	} else if w.cachedLevel > 0 {
+		// the cursor advanced to the slot's earliest timestamp, so the
+		// remaining entries now fit strictly lower levels; cascade them down
+		// to keep later pops cheap
+		rest := *slot
+		*slot = nil
+		w.occupied[w.cachedLevel][w.cachedIdx>>6] &^= 1 << uint(w.cachedIdx&63)
+		for _, r := range rest {
+			w.count--
+			w.schedule(r)
+		}
+	}
+
+	return e
+}
+
+// compactLive drops stale entries in place and releases references held by
+// the freed tail.
+func compactLive(entries []wheelEntry) []wheelEntry {
+	live := entries[:0]
+	for _, e := range entries {
+		if e.live() {
+			live = append(live, e)
+		}
+	}
+	for i := len(live); i < len(entries); i++ {
+		entries[i] = wheelEntry{}
+	}
+	return live
+}
+
+// slotMin returns the earliest timestamp among the (live) entries of a slot
+// and whether an alarm entry carries it.
+func slotMin(entries []wheelEntry) (uint64, bool) {
+	minTs := entries[0].timestamp
+	hasAlarm := entries[0].alarm != nil
+	for _, e := range entries[1:] {
+		if e.timestamp < minTs {
+			minTs = e.timestamp
+			hasAlarm = e.alarm != nil
+		} else if e.timestamp == minTs && e.alarm != nil {
+			hasAlarm = true
+		}
+	}
+	return minTs, hasAlarm
+}
+
+// eventScheduler holds the pending alarms of all nodes and the queued frame
+// deliveries in one timing wheel, replacing the two binary heaps formerly
+// kept in alarm_mgr.go and send_queue.go.
+type eventScheduler struct {
+	wheel    timingWheel
+	alarms   map[NodeId]*alarmEvent
+	failures map[NodeId]*failureEvent
+	sends    int
+}
+
+func newEventScheduler() *eventScheduler {
+	return &eventScheduler{
+		alarms:   map[NodeId]*alarmEvent{},
+		failures: map[NodeId]*failureEvent{},
+	}
+}
+
+func (es *eventScheduler) AddNode(nodeid NodeId) {
+	simplelogger.AssertNil(es.alarms[nodeid])
+	es.alarms[nodeid] = &alarmEvent{
+		NodeId:    nodeid,
+		Timestamp: Ever,
+	}
+}
+
+func (es *eventScheduler) DeleteNode(id NodeId) {
+	e := es.alarms[id]
+	simplelogger.AssertNotNil(e)
+	es.SetTimestamp(id, Ever)
+	delete(es.alarms, id)
+
+	if es.failures[id] != nil {
+		es.SetFailureTimestamp(id, Ever)
+		delete(es.failures, id)
+	}
+}
+
+// SetFailureTimestamp schedules the node's next failure-control transition,
+// or cancels it when timestamp is Ever. Only nodes with a failure time
+// configured carry such an entry, so non-failing nodes pay no cost.
+func (es *eventScheduler) SetFailureTimestamp(nodeid NodeId, timestamp uint64) {
+	e := es.failures[nodeid]
+	if e == nil {
+		if timestamp == Ever {
+			return
+		}
+		e = &failureEvent{NodeId: nodeid, Timestamp: Ever}
+		es.failures[nodeid] = e
+	}
+
+	if e.Timestamp == timestamp {
+		return
+	}
+
+	if e.Timestamp != Ever {
+		// the old wheel entry turns stale and is dropped lazily
+		es.wheel.invalidate(e.Timestamp)
+	}
+	e.Timestamp = timestamp
+	if timestamp != Ever {
+		es.wheel.schedule(wheelEntry{timestamp: timestamp, fail: e})
+	}
+}
+
+func (es *eventScheduler) SetNotified(id NodeId) {
+	es.SetTimestamp(id, Ever)
+}
+
+func (es *eventScheduler) SetTimestamp(nodeid NodeId, timestamp uint64) {
+	e := es.alarms[nodeid]
+	simplelogger.AssertNotNil(e)
+
+	if e.Timestamp == timestamp {
+		return
+	}
+
+	if e.Timestamp != Ever {
+		// the old wheel entry turns stale and is dropped lazily
+		es.wheel.invalidate(e.Timestamp)
+	}
+	e.Timestamp = timestamp
+	if timestamp != Ever {
+		es.wheel.schedule(wheelEntry{timestamp: timestamp, alarm: e})
+	}
+}
+
+func (es *eventScheduler) GetTimestamp(nodeid NodeId) uint64 {
+	e := es.alarms[nodeid]
+	simplelogger.AssertNotNil(e)
+
+	return e.Timestamp
+}
+
+func (es *eventScheduler) Add(timestamp uint64, id NodeId, data []byte) {
+	es.sends++
+	it := getSendItem()
+	it.Timestamp = timestamp
+	it.NodeId = id
+	it.Data = data
+	es.wheel.schedule(wheelEntry{timestamp: timestamp, send: it})
+}
+
+// AddOwned adds a send item that takes over the pooled event backing its data.
+func (es *eventScheduler) AddOwned(timestamp uint64, id NodeId, evt *event) {
+	es.sends++
+	it := getSendItem()
+	it.Timestamp = timestamp
+	it.NodeId = id
+	it.Data = evt.Data
+	it.evt = evt
+	es.wheel.schedule(wheelEntry{timestamp: timestamp, send: it})
+}
+
+// AddItem re-adds a previously popped send item.
+func (es *eventScheduler) AddItem(item *sendItem) {
+	es.sends++
+	es.wheel.schedule(wheelEntry{timestamp: item.Timestamp, send: item})
+}
+
+func (es *eventScheduler) SendQueueLen() int {
+	return es.sends
+}
+
+// NextTimestamp returns the earliest pending alarm or send timestamp, or Ever
+// if nothing is scheduled.
+func (es *eventScheduler) NextTimestamp() uint64 {
+	return es.wheel.nextTimestamp()
+}
+
+// PopNext removes and returns the earliest entry; alarms come before sends at
+// the same timestamp, matching the dispatch order of the former heaps. A
+// popped alarm stays unscheduled until the node sets a new one.
+func (es *eventScheduler) PopNext() schedItem {
+	e := es.wheel.pop()
+	if e.alarm != nil {
+		e.alarm.Timestamp = Ever
+		return schedItem{Timestamp: e.timestamp, NodeId: e.alarm.NodeId}
+	}
+	if e.fail != nil {
+		e.fail.Timestamp = Ever
+		return schedItem{Timestamp: e.timestamp, NodeId: e.fail.NodeId, Fail: true}
+	}
+
+	es.sends--
+	return schedItem{Timestamp: e.timestamp, NodeId: e.send.NodeId, Send: e.send}
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"math/rand"
+	"sort"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+)
+
+func TestEventScheduler_Sends(t *testing.T) {
+	es := newEventScheduler()
+	assert.Equal(t, 0, es.SendQueueLen())
+	assert.Equal(t, Ever, es.NextTimestamp())
+
+	es.Add(2, 2, nil)
+	assert.Equal(t, uint64(2), es.NextTimestamp())
+	es.Add(1, 1, nil)
+	assert.Equal(t, uint64(1), es.NextTimestamp())
+	es.Add(3, 3, nil)
+	assert.Equal(t, uint64(1), es.NextTimestamp())
+	assert.Equal(t, 3, es.SendQueueLen())
+
+	it := es.PopNext()
+	assert.True(t, it.NodeId == 1 && it.Timestamp == 1)
+	it = es.PopNext()
+	assert.True(t, it.NodeId == 2 && it.Timestamp == 2)
+	it = es.PopNext()
+	assert.True(t, it.NodeId == 3 && it.Timestamp == 3)
+	assert.Equal(t, 0, es.SendQueueLen())
+	assert.Equal(t, Ever, es.NextTimestamp())
+}
+
+func TestEventScheduler_AddOwned(t *testing.T) {
+	es := newEventScheduler()
+	evt := getEvent()
+	evt.Data = evt.payload[11:20]
+	es.AddOwned(1, 1, evt)
+
+	it := es.PopNext()
+	assert.True(t, it.Send != nil && it.Send.evt == evt)
+	assert.Equal(t, 9, len(it.Send.Data))
+
+	es.AddItem(it.Send)
+	assert.Equal(t, uint64(1), es.NextTimestamp())
+	it = es.PopNext()
+	assert.True(t, it.Send.evt == evt)
+	putEvent(evt)
+}
+
+func TestEventScheduler_Alarms(t *testing.T) {
+	es := newEventScheduler()
+	es.AddNode(1)
+	es.AddNode(2)
+	assert.Equal(t, Ever, es.NextTimestamp())
+	assert.Equal(t, Ever, es.GetTimestamp(1))
+
+	es.SetTimestamp(1, 100)
+	es.SetTimestamp(2, 50)
+	assert.Equal(t, uint64(50), es.NextTimestamp())
+
+	// moving an alarm invalidates its old entry
+	es.SetTimestamp(2, 200)
+	assert.Equal(t, uint64(100), es.NextTimestamp())
+	es.SetNotified(2)
+	assert.Equal(t, Ever, es.GetTimestamp(2))
+
+	it := es.PopNext()
+	assert.True(t, it.NodeId == 1 && it.Timestamp == 100 && it.Send == nil)
+	// a popped alarm stays unscheduled until the node sets a new one
+	assert.Equal(t, Ever, es.GetTimestamp(1))
+	assert.Equal(t, Ever, es.NextTimestamp())
+
+	es.SetTimestamp(1, 300)
+	es.DeleteNode(1)
+	es.DeleteNode(2)
+	assert.Equal(t, Ever, es.NextTimestamp())
+}
+
+func TestEventScheduler_AlarmBeforeSend(t *testing.T) {
+	es := newEventScheduler()
+	es.AddNode(1)
+	es.Add(100, 2, nil)
+	es.SetTimestamp(1, 100)
+
+	it := es.PopNext()
+	assert.True(t, it.Send == nil && it.NodeId == 1)
+	it = es.PopNext()
+	assert.True(t, it.Send != nil && it.NodeId == 2)
+}
+
+// TestEventScheduler_Ordering schedules timestamps spanning all wheel levels
+// and verifies they pop in sorted order.
+func TestEventScheduler_Ordering(t *testing.T) {
+	rnd := rand.New(rand.NewSource(1))
+	es := newEventScheduler()
+
+	var want []uint64
+	addRandom := func(n int) {
+		for i := 0; i < n; i++ {
+			ts := es.wheel.cursor + uint64(rnd.Int63n(1<<uint(8+rnd.Intn(40))))
+			es.Add(ts, 1, nil)
+			want = append(want, ts)
+		}
+	}
+
+	addRandom(500)
+	for i := 0; len(want) > 0; i++ {
+		sort.Slice(want, func(a, b int) bool { return want[a] < want[b] })
+		assert.Equal(t, want[0], es.NextTimestamp())
+		assert.Equal(t, want[0], es.PopNext().Timestamp)
+		want = want[1:]
+
+		// interleave pops with new (later) timestamps
+		if i%3 == 0 && i < 600 {
+			addRandom(2)
+		}
+	}
+	assert.Equal(t, Ever, es.NextTimestamp())
+	assert.Equal(t, 0, es.SendQueueLen())
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	. "github.com/openthread/ot-ns/types"
+)
+
+// topologyIndex maintains incremental views of the network topology that the
+// dispatcher learns from status pushes: partition membership, parent/child
+// adjacency and the router graph. Queries like the partitions CLI command are
+// served from these maps instead of iterating node state, so periodic
+// monitoring does not perturb the simulation. All methods must be called on
+// the dispatcher goroutine.
+type topologyIndex struct {
+	// partitions maps a partition id to its member nodes; nodes that have not
+	// announced a partition yet are members of partition 0
+	partitions map[uint32]map[NodeId]struct{}
+	// parents maps a child node to the extended address of its parent
+	parents map[NodeId]uint64
+	// children maps a parent node to the extended addresses of its children
+	children map[NodeId]map[uint64]struct{}
+	// routerLinks maps a router to the extended addresses in its router table
+	routerLinks map[NodeId]map[uint64]struct{}
+}
+
+func newTopologyIndex() *topologyIndex {
+	return &topologyIndex{
+		partitions:  map[uint32]map[NodeId]struct{}{},
+		parents:     map[NodeId]uint64{},
+		children:    map[NodeId]map[uint64]struct{}{},
+		routerLinks: map[NodeId]map[uint64]struct{}{},
+	}
+}
+
+func (ti *topologyIndex) onNodeAdded(node *Node) {
+	ti.addToPartition(node.PartitionId, node.Id)
+}
+
+func (ti *topologyIndex) onNodeDeleted(node *Node) {
+	ti.removeFromPartition(node.PartitionId, node.Id)
+	delete(ti.parents, node.Id)
+	delete(ti.children, node.Id)
+	delete(ti.routerLinks, node.Id)
+}
+
+func (ti *topologyIndex) setNodePartition(node *Node, parid uint32) {
+	if node.PartitionId == parid {
+		return
+	}
+
+	ti.removeFromPartition(node.PartitionId, node.Id)
+	ti.addToPartition(parid, node.Id)
+	node.PartitionId = parid
+}
+
+func (ti *topologyIndex) addToPartition(parid uint32, nodeid NodeId) {
+	members := ti.partitions[parid]
+	if members == nil {
+		members = map[NodeId]struct{}{}
+		ti.partitions[parid] = members
+	}
+	members[nodeid] = struct{}{}
+}
+
+func (ti *topologyIndex) removeFromPartition(parid uint32, nodeid NodeId) {
+	members := ti.partitions[parid]
+	delete(members, nodeid)
+	if len(members) == 0 {
+		delete(ti.partitions, parid)
+	}
+}
+
+func (ti *topologyIndex) setParent(nodeid NodeId, extaddr uint64) {
+	ti.parents[nodeid] = extaddr
+}
+
+func (ti *topologyIndex) addChild(nodeid NodeId, extaddr uint64) {
+	childs := ti.children[nodeid]
+	if childs == nil {
+		childs = map[uint64]struct{}{}
+		ti.children[nodeid] = childs
+	}
+	childs[extaddr] = struct{}{}
+}
+
+func (ti *topologyIndex) removeChild(nodeid NodeId, extaddr uint64) {
+	delete(ti.children[nodeid], extaddr)
+}
+
+func (ti *topologyIndex) addRouterLink(nodeid NodeId, extaddr uint64) {
+	links := ti.routerLinks[nodeid]
+	if links == nil {
+		links = map[uint64]struct{}{}
+		ti.routerLinks[nodeid] = links
+	}
+	links[extaddr] = struct{}{}
+}
+
+func (ti *topologyIndex) removeRouterLink(nodeid NodeId, extaddr uint64) {
+	delete(ti.routerLinks[nodeid], extaddr)
+}
+
+// Partitions returns the member nodes of every partition. It must be called
+// on the dispatcher goroutine (e.g. via postAsyncWait).
+func (d *Dispatcher) Partitions() map[uint32][]NodeId {
+	pars := make(map[uint32][]NodeId, len(d.topology.partitions))
+	for parid, members := range d.topology.partitions {
+		nodeids := make([]NodeId, 0, len(members))
+		for nodeid := range members {
+			nodeids = append(nodeids, nodeid)
+		}
+		pars[parid] = nodeids
+	}
+	return pars
+}
+
+// NodeParent returns the extended address of the node's parent, or 0 if none
+// is known. It must be called on the dispatcher goroutine.
+func (d *Dispatcher) NodeParent(nodeid NodeId) uint64 {
+	return d.topology.parents[nodeid]
+}
+
+// NodeChildren returns the extended addresses of the node's children. It must
+// be called on the dispatcher goroutine.
+func (d *Dispatcher) NodeChildren(nodeid NodeId) []uint64 {
+	return extaddrSetToList(d.topology.children[nodeid])
+}
+
+// RouterNeighbors returns the extended addresses in the node's router table.
+// It must be called on the dispatcher goroutine.
+func (d *Dispatcher) RouterNeighbors(nodeid NodeId) []uint64 {
+	return extaddrSetToList(d.topology.routerLinks[nodeid])
+}
+
+func extaddrSetToList(set map[uint64]struct{}) []uint64 {
+	if len(set) == 0 {
+		return nil
+	}
+	list := make([]uint64, 0, len(set))
+	for extaddr := range set {
+		list = append(list, extaddr)
+	}
+	return list
+}
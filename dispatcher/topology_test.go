@@ -0,0 +1,88 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+func TestTopologyIndex_Partitions(t *testing.T) {
+	d := &Dispatcher{topology: newTopologyIndex()}
+	node1 := &Node{Id: 1}
+	node2 := &Node{Id: 2}
+	d.topology.onNodeAdded(node1)
+	d.topology.onNodeAdded(node2)
+
+	// nodes without an announced partition are members of partition 0
+	pars := d.Partitions()
+	assert.Equal(t, 1, len(pars))
+	assert.Equal(t, 2, len(pars[0]))
+
+	d.topology.setNodePartition(node1, 0x11223344)
+	assert.Equal(t, uint32(0x11223344), node1.PartitionId)
+	pars = d.Partitions()
+	assert.Equal(t, []NodeId{1}, pars[0x11223344])
+	assert.Equal(t, []NodeId{2}, pars[0])
+
+	// moving the last member of a partition removes the empty set
+	d.topology.setNodePartition(node2, 0x11223344)
+	pars = d.Partitions()
+	assert.Equal(t, 1, len(pars))
+	assert.Equal(t, 2, len(pars[0x11223344]))
+
+	d.topology.onNodeDeleted(node1)
+	d.topology.onNodeDeleted(node2)
+	assert.Equal(t, 0, len(d.Partitions()))
+}
+
+func TestTopologyIndex_Adjacency(t *testing.T) {
+	d := &Dispatcher{topology: newTopologyIndex()}
+	node1 := &Node{Id: 1}
+	d.topology.onNodeAdded(node1)
+
+	d.topology.setParent(1, 0xaabb)
+	assert.Equal(t, uint64(0xaabb), d.NodeParent(1))
+
+	d.topology.addChild(1, 0x1111)
+	d.topology.addChild(1, 0x2222)
+	assert.Equal(t, 2, len(d.NodeChildren(1)))
+	d.topology.removeChild(1, 0x1111)
+	assert.Equal(t, []uint64{0x2222}, d.NodeChildren(1))
+
+	d.topology.addRouterLink(1, 0x3333)
+	assert.Equal(t, []uint64{0x3333}, d.RouterNeighbors(1))
+	d.topology.removeRouterLink(1, 0x3333)
+	assert.Nil(t, d.RouterNeighbors(1))
+
+	d.topology.onNodeDeleted(node1)
+	assert.Equal(t, uint64(0), d.NodeParent(1))
+	assert.Nil(t, d.NodeChildren(1))
+}
@@ -0,0 +1,296 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"fmt"
+	"sort"
+
+	"github.com/pkg/errors"
+	"github.com/simonlingoogle/go-simplelogger"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+// TrafficFlowConfig describes a declarative traffic flow: every source node
+// pings the destination addresses in round-robin order at the given aggregate
+// rate. Flows are paced on the simulated clock, so the generated load is
+// deterministic and independent of the real-time speed the simulation runs at.
+type TrafficFlowConfig struct {
+	SrcNodes []NodeId
+	DstAddrs []string
+	Rate     float64 // pings per second (aggregate over the flow)
+	DataSize int
+	Duration uint64 // simulated duration in microseconds, 0 to run until stopped
+}
+
+// TrafficFlowStats is a snapshot of the delivery statistics of one flow. Delays
+// are in microseconds and cover replied pings only; Lost counts pings whose
+// reply timed out (see maxPingDelayUs in Node.go).
+type TrafficFlowStats struct {
+	Id       int
+	Active   bool
+	Sent     uint64
+	Replied  uint64
+	Lost     uint64
+	MinDelay uint64
+	MaxDelay uint64
+	SumDelay uint64
+}
+
+type trafficFlow struct {
+	cfg      TrafficFlowConfig
+	stats    TrafficFlowStats
+	srcSet   map[NodeId]struct{}
+	dstSet   map[string]struct{}
+	interval uint64 // microseconds between consecutive pings
+	nextSend uint64
+	endTime  uint64
+	rrSrc    int
+	rrDst    int
+}
+
+// trafficGen schedules the pings of all active flows directly on the
+// dispatcher's simulated clock. It injects each ping as a single UART write to
+// the source node and attributes the results reported back through the
+// ping_request/ping_reply status pushes (see handleStatusPush).
+type trafficGen struct {
+	d          *Dispatcher
+	flows      map[int]*trafficFlow
+	nextFlowId int
+	nextDue    uint64 // earliest nextSend over all active flows, Ever if none
+}
+
+func newTrafficGen(d *Dispatcher) *trafficGen {
+	return &trafficGen{
+		d:          d,
+		flows:      map[int]*trafficFlow{},
+		nextFlowId: 1,
+		nextDue:    Ever,
+	}
+}
+
+func (tg *trafficGen) addFlow(cfg TrafficFlowConfig) (int, error) {
+	if tg.d.cfg.Real {
+		return 0, errors.Errorf("traffic flows are not supported in real mode")
+	}
+	if tg.d.cfg.Parallel {
+		// island nodes run ahead of the dispatcher clock, so pings can not be
+		// injected at dispatcher time (see processParallelBatch)
+		return 0, errors.Errorf("traffic flows are not supported in parallel mode")
+	}
+	if len(cfg.SrcNodes) == 0 || len(cfg.DstAddrs) == 0 {
+		return 0, errors.Errorf("traffic flow needs at least one source and one destination")
+	}
+	if cfg.Rate <= 0 {
+		return 0, errors.Errorf("traffic flow rate must be positive")
+	}
+	if cfg.DataSize < 4 {
+		// pings smaller than 4 bytes can not carry the timestamp that the
+		// ping_request/ping_reply accounting relies on
+		return 0, errors.Errorf("traffic flow datasize must be at least 4")
+	}
+	for _, id := range cfg.SrcNodes {
+		if tg.d.nodes[id] == nil {
+			return 0, errors.Errorf("source node %d not found", id)
+		}
+	}
+
+	f := &trafficFlow{
+		cfg:      cfg,
+		srcSet:   map[NodeId]struct{}{},
+		dstSet:   map[string]struct{}{},
+		interval: uint64(1000000 / cfg.Rate),
+		nextSend: tg.d.CurTime,
+		endTime:  Ever,
+	}
+	if f.interval == 0 {
+		f.interval = 1
+	}
+	if cfg.Duration > 0 {
+		f.endTime = tg.d.CurTime + cfg.Duration
+	}
+	for _, id := range cfg.SrcNodes {
+		f.srcSet[id] = struct{}{}
+	}
+	for _, addr := range cfg.DstAddrs {
+		f.dstSet[addr] = struct{}{}
+	}
+
+	id := tg.nextFlowId
+	tg.nextFlowId++
+	f.stats.Id = id
+	f.stats.Active = true
+	tg.flows[id] = f
+
+	if f.nextSend < tg.nextDue {
+		tg.nextDue = f.nextSend
+	}
+	return id, nil
+}
+
+func (tg *trafficGen) stopFlow(id int) error {
+	f := tg.flows[id]
+	if f == nil {
+		return errors.Errorf("traffic flow %d not found", id)
+	}
+	f.stats.Active = false
+	return nil
+}
+
+func (tg *trafficGen) stopAllFlows() {
+	for _, f := range tg.flows {
+		f.stats.Active = false
+	}
+}
+
+func (tg *trafficGen) flowStats() []TrafficFlowStats {
+	stats := make([]TrafficFlowStats, 0, len(tg.flows))
+	for _, f := range tg.flows {
+		stats = append(stats, f.stats)
+	}
+	sort.Slice(stats, func(i, j int) bool { return stats[i].Id < stats[j].Id })
+	return stats
+}
+
+// onTimeAdvanced sends the pings of all flows that became due at the new
+// simulated time. It is called from advanceTime on every clock advance, so the
+// fast path is a single comparison against the cached earliest deadline.
+func (tg *trafficGen) onTimeAdvanced(ts uint64) {
+	if ts < tg.nextDue {
+		return
+	}
+
+	nextDue := Ever
+	for _, f := range tg.flows {
+		if !f.stats.Active {
+			continue
+		}
+		if f.endTime <= ts {
+			f.stats.Active = false
+			continue
+		}
+		for f.nextSend <= ts {
+			tg.sendPing(f)
+			f.nextSend += f.interval
+		}
+		if f.nextSend < nextDue {
+			nextDue = f.nextSend
+		}
+	}
+	tg.nextDue = nextDue
+}
+
+func (tg *trafficGen) sendPing(f *trafficFlow) {
+	// skip deleted source nodes, but keep them in the rotation so that the
+	// load on the remaining sources is unchanged
+	for i := 0; i < len(f.cfg.SrcNodes); i++ {
+		src := f.cfg.SrcNodes[f.rrSrc]
+		f.rrSrc = (f.rrSrc + 1) % len(f.cfg.SrcNodes)
+
+		if tg.d.nodes[src] == nil {
+			continue
+		}
+
+		dst := f.cfg.DstAddrs[f.rrDst]
+		f.rrDst = (f.rrDst + 1) % len(f.cfg.DstAddrs)
+
+		cmd := fmt.Sprintf("ping %s %d 1 1 64\n", dst, f.cfg.DataSize)
+		tg.d.SendToUART(src, []byte(cmd))
+		f.stats.Sent++
+		return
+	}
+
+	simplelogger.Debugf("traffic flow %d has no sources left", f.stats.Id)
+	f.stats.Active = false
+}
+
+// onPingResult attributes a ping result reported by handleStatusPush to the
+// first flow matching the source node, destination address and data size.
+func (tg *trafficGen) onPingResult(src NodeId, dst string, datasize int, delay uint64) {
+	if len(tg.flows) == 0 {
+		return
+	}
+
+	matchId := 0
+	for id, f := range tg.flows {
+		if f.cfg.DataSize != datasize {
+			continue
+		}
+		if _, ok := f.srcSet[src]; !ok {
+			continue
+		}
+		if _, ok := f.dstSet[dst]; !ok {
+			continue
+		}
+		if matchId == 0 || id < matchId {
+			matchId = id
+		}
+	}
+	if matchId == 0 {
+		return
+	}
+
+	f := tg.flows[matchId]
+	if delay >= maxPingDelayUs {
+		f.stats.Lost++
+		return
+	}
+
+	f.stats.Replied++
+	f.stats.SumDelay += delay
+	if f.stats.Replied == 1 || delay < f.stats.MinDelay {
+		f.stats.MinDelay = delay
+	}
+	if delay > f.stats.MaxDelay {
+		f.stats.MaxDelay = delay
+	}
+}
+
+// AddTrafficFlow creates a traffic flow and returns its id. Must be called on
+// the dispatcher goroutine (e.g. via PostAsync).
+func (d *Dispatcher) AddTrafficFlow(cfg TrafficFlowConfig) (int, error) {
+	return d.trafficGen.addFlow(cfg)
+}
+
+// StopTrafficFlow deactivates one traffic flow; its statistics remain
+// available. Must be called on the dispatcher goroutine.
+func (d *Dispatcher) StopTrafficFlow(id int) error {
+	return d.trafficGen.stopFlow(id)
+}
+
+// StopAllTrafficFlows deactivates all traffic flows. Must be called on the
+// dispatcher goroutine.
+func (d *Dispatcher) StopAllTrafficFlows() {
+	d.trafficGen.stopAllFlows()
+}
+
+// TrafficFlowStatsAll returns the statistics of all flows, ordered by flow id.
+// Must be called on the dispatcher goroutine.
+func (d *Dispatcher) TrafficFlowStatsAll() []TrafficFlowStats {
+	return d.trafficGen.flowStats()
+}
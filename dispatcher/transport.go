@@ -0,0 +1,186 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package dispatcher
+
+import (
+	"fmt"
+	"net"
+	"os"
+	"strconv"
+	"strings"
+
+	. "github.com/openthread/ot-ns/types"
+)
+
+const (
+	// TransportTypeUdp exchanges events with nodes over loopback UDP
+	// (port = dispatcher port + node id). This is the default.
+	TransportTypeUdp = "udp"
+	// TransportTypeUnix exchanges events over a unix datagram socket, avoiding
+	// the loopback UDP stack. The simulated platform must bind its own socket
+	// to "<dispatcher socket>-node-<id>" and send events to the dispatcher
+	// socket, whose path is exported in the OTNS_UNIX_SOCKET environment
+	// variable.
+	TransportTypeUnix = "unix"
+)
+
+// eventTransport abstracts the datagram channel between the dispatcher and
+// the simulated nodes.
+type eventTransport interface {
+	// ReadEvent reads one event datagram into buf and returns its length, the
+	// id of the sending node and an opaque reply address for WriteEvent.
+	ReadEvent(buf []byte) (n int, nodeid NodeId, srcAddr net.Addr, err error)
+	// WriteEvent sends one event datagram to the given reply address.
+	WriteEvent(msg []byte, dstAddr net.Addr) error
+	Close() error
+	String() string
+}
+
+func newEventTransport(cfg *Config) (eventTransport, error) {
+	switch cfg.Transport {
+	case "", TransportTypeUdp:
+		return newUdpTransport(cfg.Host, cfg.Port)
+	case TransportTypeUnix:
+		return newUnixTransport(cfg.Port)
+	default:
+		return nil, fmt.Errorf("unknown transport type: %s", cfg.Transport)
+	}
+}
+
+type udpTransport struct {
+	ln       *net.UDPConn
+	addr     *net.UDPAddr
+	basePort int
+}
+
+func newUdpTransport(host string, port int) (*udpTransport, error) {
+	udpAddr, err := net.ResolveUDPAddr("udp4", fmt.Sprintf("%s:%d", host, port))
+	if err != nil {
+		return nil, err
+	}
+	ln, err := net.ListenUDP("udp", udpAddr)
+	if err != nil {
+		return nil, err
+	}
+	_ = ln.SetWriteBuffer(25 * 1024 * 1024)
+	_ = ln.SetReadBuffer(25 * 1024 * 1024)
+
+	return &udpTransport{
+		ln:       ln,
+		addr:     udpAddr,
+		basePort: port,
+	}, nil
+}
+
+func (t *udpTransport) ReadEvent(buf []byte) (int, NodeId, net.Addr, error) {
+	n, srcaddr, err := t.ln.ReadFromUDP(buf)
+	if err != nil {
+		return 0, 0, nil, err
+	}
+
+	return n, srcaddr.Port - t.basePort, srcaddr, nil
+}
+
+func (t *udpTransport) WriteEvent(msg []byte, dstAddr net.Addr) error {
+	_, err := t.ln.WriteToUDP(msg, dstAddr.(*net.UDPAddr))
+	return err
+}
+
+func (t *udpTransport) Close() error {
+	return t.ln.Close()
+}
+
+func (t *udpTransport) String() string {
+	return t.addr.String()
+}
+
+type unixTransport struct {
+	ln   *net.UnixConn
+	path string
+}
+
+func newUnixTransport(port int) (*unixTransport, error) {
+	path := fmt.Sprintf("/tmp/otns-%d.sock", port)
+	_ = os.RemoveAll(path)
+
+	ln, err := net.ListenUnixgram("unixgram", &net.UnixAddr{Name: path, Net: "unixgram"})
+	if err != nil {
+		return nil, err
+	}
+	_ = ln.SetWriteBuffer(25 * 1024 * 1024)
+	_ = ln.SetReadBuffer(25 * 1024 * 1024)
+
+	// child node processes find the dispatcher socket through the environment
+	if err = os.Setenv("OTNS_UNIX_SOCKET", path); err != nil {
+		return nil, err
+	}
+
+	return &unixTransport{
+		ln:   ln,
+		path: path,
+	}, nil
+}
+
+func (t *unixTransport) ReadEvent(buf []byte) (int, NodeId, net.Addr, error) {
+	n, srcaddr, err := t.ln.ReadFromUnix(buf)
+	if err != nil {
+		return 0, 0, nil, err
+	}
+
+	return n, parseUnixSocketNodeId(srcaddr.Name), srcaddr, nil
+}
+
+// parseUnixSocketNodeId extracts the node id from a node socket path of the
+// form "<dispatcher socket>-node-<id>".
+func parseUnixSocketNodeId(path string) NodeId {
+	idx := strings.LastIndex(path, "-node-")
+	if idx < 0 {
+		return InvalidNodeId
+	}
+
+	nodeid, err := strconv.Atoi(path[idx+len("-node-"):])
+	if err != nil {
+		return InvalidNodeId
+	}
+
+	return nodeid
+}
+
+func (t *unixTransport) WriteEvent(msg []byte, dstAddr net.Addr) error {
+	_, err := t.ln.WriteToUnix(msg, dstAddr.(*net.UnixAddr))
+	return err
+}
+
+func (t *unixTransport) Close() error {
+	err := t.ln.Close()
+	_ = os.RemoveAll(t.path)
+	return err
+}
+
+func (t *unixTransport) String() string {
+	return t.path
+}
@@ -29,48 +29,37 @@ package dispatcher
 import (
 	"testing"
 
+	. "github.com/openthread/ot-ns/types"
 	"github.com/stretchr/testify/assert"
 )
 
-func TestSendQueue_Add(t *testing.T) {
-	q := newSendQueue()
-	q.Add(2, 2, nil)
-	q.Add(1, 1, nil)
-	q.Add(3, 3, nil)
+func TestParseUnixSocketNodeId(t *testing.T) {
+	assert.Equal(t, 3, parseUnixSocketNodeId("/tmp/otns-9000.sock-node-3"))
+	assert.Equal(t, 42, parseUnixSocketNodeId("/tmp/otns-9000.sock-node-42"))
+	assert.Equal(t, InvalidNodeId, parseUnixSocketNodeId("/tmp/otns-9000.sock"))
+	assert.Equal(t, InvalidNodeId, parseUnixSocketNodeId("/tmp/otns-9000.sock-node-x"))
 }
 
-func TestSendQueue_Len(t *testing.T) {
-	q := newSendQueue()
-	assert.Equal(t, 0, q.Len())
-	q.Add(2, 2, nil)
-	assert.Equal(t, 1, q.Len())
-	q.Add(1, 1, nil)
-	assert.Equal(t, 2, q.Len())
-	q.Add(3, 3, nil)
-	assert.Equal(t, 3, q.Len())
-}
+func TestUdpTransportRoundTrip(t *testing.T) {
+	tp, err := newUdpTransport("localhost", 19000)
+	assert.NoError(t, err)
+	defer func() { _ = tp.Close() }()
 
-func TestSendQueue_NextTimestamp(t *testing.T) {
-	q := newSendQueue()
-	assert.Equal(t, Ever, q.NextTimestamp())
-	q.Add(2, 2, nil)
-	assert.Equal(t, uint64(2), q.NextTimestamp())
-	q.Add(1, 1, nil)
-	assert.Equal(t, uint64(1), q.NextTimestamp())
-	q.Add(3, 3, nil)
-	assert.Equal(t, uint64(1), q.NextTimestamp())
-}
+	peer, err := newUdpTransport("localhost", 19003)
+	assert.NoError(t, err)
+	defer func() { _ = peer.Close() }()
+
+	_ = peer.WriteEvent([]byte("hello"), tp.addr)
 
-func TestSendQueue_PopNext(t *testing.T) {
-	q := newSendQueue()
-	q.Add(2, 2, nil)
-	q.Add(1, 1, nil)
-	q.Add(3, 3, nil)
+	buf := make([]byte, 100)
+	n, nodeid, srcaddr, err := tp.ReadEvent(buf)
+	assert.NoError(t, err)
+	assert.Equal(t, 5, n)
+	assert.Equal(t, 3, nodeid)
+	assert.NotNil(t, srcaddr)
 
-	it := q.PopNext()
-	assert.True(t, it.NodeId == 1 && it.Timestamp == 1)
-	it = q.PopNext()
-	assert.True(t, it.NodeId == 2 && it.Timestamp == 2)
-	it = q.PopNext()
-	assert.True(t, it.NodeId == 3 && it.Timestamp == 3)
+	_ = tp.WriteEvent([]byte("world"), srcaddr)
+	n, _, _, err = peer.ReadEvent(buf)
+	assert.NoError(t, err)
+	assert.Equal(t, 5, n)
 }
@@ -29,6 +29,7 @@ package wpan
 import (
 	"encoding/binary"
 	"fmt"
+	"sync"
 )
 
 type FrameType = uint16
@@ -120,23 +121,75 @@ func (f *MacFrame) String() string {
 	return fmt.Sprintf("MAC,FC:%s,Seq:%d,Dst:%s", f.FrameControl, f.Seq, dstAddrS)
 }
 
-func Dissect(data []byte) *MacFrame {
-	frame := &MacFrame{}
-	frame.Channel = data[0]
-	frame.FrameControl.Dissect(data[1:3])
-	frame.Seq = data[3]
-	if frame.FrameControl.FrameType() == FrameTypeAck {
-		return frame
+func (f *MacFrame) dissect(data []byte) {
+	*f = MacFrame{}
+	f.Channel = data[0]
+	f.FrameControl.Dissect(data[1:3])
+	f.Seq = data[3]
+	if f.FrameControl.FrameType() == FrameTypeAck {
+		return
 	}
 
-	frame.DstPanId = binary.LittleEndian.Uint16(data[4:6])
-	dstAddrMode := frame.FrameControl.DstAddrMode()
+	f.DstPanId = binary.LittleEndian.Uint16(data[4:6])
+	dstAddrMode := f.FrameControl.DstAddrMode()
 
 	if dstAddrMode == DstAddrModeShort { // SHORT
-		frame.DstAddrShort = binary.LittleEndian.Uint16(data[6:8])
+		f.DstAddrShort = binary.LittleEndian.Uint16(data[6:8])
 	} else if dstAddrMode == DstAddrModeExtended { // EXTEND
-		frame.DstAddrExtended = binary.LittleEndian.Uint64(data[6:14])
+		f.DstAddrExtended = binary.LittleEndian.Uint64(data[6:14])
 	}
+}
+
+func Dissect(data []byte) *MacFrame {
+	frame := &MacFrame{}
+	frame.dissect(data)
+	return frame
+}
 
+var macFramePool = sync.Pool{
+	New: func() interface{} {
+		return &MacFrame{}
+	},
+}
+
+// DissectPooled is like Dissect but reuses MacFrame structs from a pool;
+// release the frame with ReleaseFrame once it is no longer referenced.
+func DissectPooled(data []byte) *MacFrame {
+	frame := macFramePool.Get().(*MacFrame)
+	frame.dissect(data)
 	return frame
 }
+
+func ReleaseFrame(f *MacFrame) {
+	macFramePool.Put(f)
+}
+
+// MacFrameView is a non-allocating view of a transmitted frame (channel byte
+// followed by the PSDU). Header fields are decoded lazily from the raw slice
+// on access; the view must not outlive the underlying buffer. Address
+// accessors are only valid for the matching DstAddrMode of a non-ACK frame.
+type MacFrameView []byte
+
+func (v MacFrameView) Channel() uint8 {
+	return v[0]
+}
+
+func (v MacFrameView) FrameControl() FrameControl {
+	return FrameControl(binary.LittleEndian.Uint16(v[1:3]))
+}
+
+func (v MacFrameView) Seq() uint8 {
+	return v[3]
+}
+
+func (v MacFrameView) DstPanId() uint16 {
+	return binary.LittleEndian.Uint16(v[4:6])
+}
+
+func (v MacFrameView) DstAddrShort() uint16 {
+	return binary.LittleEndian.Uint16(v[6:8])
+}
+
+func (v MacFrameView) DstAddrExtended() uint64 {
+	return binary.LittleEndian.Uint64(v[6:14])
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package wpan
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+)
+
+// data frame with short destination address 0x1234, pan id 0xface, seq 0x55
+var shortAddrFrame = []byte{11, 0x01, 0x08, 0x55, 0xce, 0xfa, 0x34, 0x12}
+
+// data frame with extended destination address, pan id 0xface, seq 0x66
+var extAddrFrame = []byte{12, 0x01, 0x0c, 0x66, 0xce, 0xfa, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08}
+
+// ACK frame: only frame control and sequence number
+var ackFrame = []byte{13, 0x02, 0x00, 0x77}
+
+func TestMacFrameView(t *testing.T) {
+	v := MacFrameView(shortAddrFrame)
+	f := Dissect(shortAddrFrame)
+
+	assert.Equal(t, f.Channel, v.Channel())
+	assert.Equal(t, f.FrameControl, v.FrameControl())
+	assert.Equal(t, f.Seq, v.Seq())
+	assert.Equal(t, f.DstPanId, v.DstPanId())
+	assert.Equal(t, uint16(DstAddrModeShort), v.FrameControl().DstAddrMode())
+	assert.Equal(t, f.DstAddrShort, v.DstAddrShort())
+
+	v = MacFrameView(extAddrFrame)
+	f = Dissect(extAddrFrame)
+	assert.Equal(t, uint16(DstAddrModeExtended), v.FrameControl().DstAddrMode())
+	assert.Equal(t, f.DstAddrExtended, v.DstAddrExtended())
+
+	v = MacFrameView(ackFrame)
+	assert.Equal(t, FrameTypeAck, v.FrameControl().FrameType())
+	assert.Equal(t, uint8(0x77), v.Seq())
+}
+
+func TestDissectPooled(t *testing.T) {
+	f := DissectPooled(extAddrFrame)
+	assert.Equal(t, *Dissect(extAddrFrame), *f)
+	ReleaseFrame(f)
+
+	// a reused frame must not keep stale fields of the previous dissection
+	f = DissectPooled(ackFrame)
+	assert.Equal(t, FrameTypeAck, f.FrameControl.FrameType())
+	assert.Equal(t, uint16(0), f.DstPanId)
+	assert.Equal(t, uint64(0), f.DstAddrExtended)
+	ReleaseFrame(f)
+}
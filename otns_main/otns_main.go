@@ -27,9 +27,11 @@
 package otns_main
 
 import (
+	"expvar"
 	"flag"
 	"fmt"
 	"math/rand"
+	"net/http"
 	"os"
 	"os/signal"
 	"strconv"
@@ -56,6 +58,8 @@ import (
 
 	visualizeMulti "github.com/openthread/ot-ns/visualize/multi"
 
+	visualizeWs "github.com/openthread/ot-ns/visualize/ws"
+
 	"github.com/openthread/ot-ns/cli"
 
 	"github.com/openthread/ot-ns/simulation"
@@ -63,20 +67,30 @@ import (
 )
 
 type MainArgs struct {
-	Speed          string
-	OtCliPath      string
-	AutoGo         bool
-	ReadOnly       bool
-	LogLevel       string
-	OpenWeb        bool
-	RawMode        bool
-	Real           bool
-	ListenAddr     string
-	DispatcherHost string
-	DispatcherPort int
-	DumpPackets    bool
-	NoPcap         bool
-	NoReplay       bool
+	Speed           string
+	OtCliPath       string
+	AutoGo          bool
+	ReadOnly        bool
+	LogLevel        string
+	OpenWeb         bool
+	RawMode         bool
+	Real            bool
+	ListenAddr      string
+	DispatcherHost  string
+	DispatcherPort  int
+	DumpPackets     bool
+	DumpPacketsFile string
+	NoPcap          bool
+	NoReplay        bool
+	Parallel        bool
+	Transport       string
+	RadioModel      string
+	CoalesceEvents  bool
+	PcapFormat      string
+	PcapCompress    bool
+	PcapSync        bool
+	MetricsAddr     string
+	CtrlAddr        string
 }
 
 var (
@@ -99,8 +113,18 @@ func parseArgs() {
 	flag.BoolVar(&args.Real, "real", false, "use real mode (for real devices)")
 	flag.StringVar(&args.ListenAddr, "listen", fmt.Sprintf("localhost:%d", threadconst.InitialDispatcherPort), "specify listen address")
 	flag.BoolVar(&args.DumpPackets, "dump-packets", false, "dump packets")
+	flag.StringVar(&args.DumpPacketsFile, "dump-packets-file", "", "dump packets as binary records to this file or socket (tcp://addr, unix://path) instead of stdout")
 	flag.BoolVar(&args.NoPcap, "no-pcap", false, "do not generate Pcap")
 	flag.BoolVar(&args.NoReplay, "no-replay", false, "do not generate Replay")
+	flag.BoolVar(&args.Parallel, "parallel", false, "advance radio-connectivity islands in parallel")
+	flag.StringVar(&args.Transport, "transport", "udp", "event transport to nodes (udp|unix)")
+	flag.StringVar(&args.RadioModel, "radio-model", "disc", "radio model (disc|pathloss)")
+	flag.BoolVar(&args.CoalesceEvents, "coalesce-events", false, "pack events for one node into single datagrams (requires platform support)")
+	flag.StringVar(&args.PcapFormat, "pcap-format", "pcap", "pcap file format (pcap|pcapng)")
+	flag.BoolVar(&args.PcapCompress, "pcap-gzip", false, "gzip-compress the pcap file")
+	flag.BoolVar(&args.PcapSync, "pcap-sync", true, "sync pcap file to disk after every go period")
+	flag.StringVar(&args.MetricsAddr, "metrics", "", "serve performance metrics (expvar) on this address (e.g. localhost:9900)")
+	flag.StringVar(&args.CtrlAddr, "ctrl", "", "serve the pipelined CLI control socket on this address (e.g. localhost:8996)")
 
 	flag.Parse()
 }
@@ -159,16 +183,35 @@ func Main(ctx *progctx.ProgCtx, visualizerCreator func(ctx *progctx.ProgCtx, arg
 	if !args.NoReplay {
 		replayFn = fmt.Sprintf("otns_%s.replay", os.Getenv("PORT_OFFSET"))
 	}
+	visWsServerAddr := fmt.Sprintf("%s:%d", args.DispatcherHost, args.DispatcherPort-4)
+
 	if vis != nil {
 		vis = visualizeMulti.NewMultiVisualizer(
 			vis,
 			visualizeGrpc.NewGrpcVisualizer(visGrpcServerAddr, replayFn),
+			visualizeWs.NewWsVisualizer(visWsServerAddr),
 		)
 	} else {
-		vis = visualizeGrpc.NewGrpcVisualizer(visGrpcServerAddr, replayFn)
+		vis = visualizeMulti.NewMultiVisualizer(
+			visualizeGrpc.NewGrpcVisualizer(visGrpcServerAddr, replayFn),
+			visualizeWs.NewWsVisualizer(visWsServerAddr),
+		)
 	}
 
 	sim := createSimulation(ctx)
+
+	if args.MetricsAddr != "" {
+		expvar.Publish("otns_perf", expvar.Func(func() interface{} {
+			return sim.Dispatcher().GetPerfStats()
+		}))
+		go func() {
+			simplelogger.Infof("serving performance metrics on http://%s/debug/vars", args.MetricsAddr)
+			if err := http.ListenAndServe(args.MetricsAddr, nil); err != nil {
+				simplelogger.Errorf("metrics endpoint quited: %v", err)
+			}
+		}()
+	}
+
 	rt := cli.NewCmdRunner(ctx, sim)
 	sim.SetVisualizer(vis)
 	go sim.Run()
@@ -177,6 +220,16 @@ func Main(ctx *progctx.ProgCtx, visualizerCreator func(ctx *progctx.ProgCtx, arg
 		ctx.Cancel(errors.Wrapf(err, "console exit"))
 	}()
 
+	if args.CtrlAddr != "" {
+		ctrlServer := cli.NewCtrlServer(ctx, rt, args.CtrlAddr)
+		go func() {
+			err := ctrlServer.Run()
+			if err != nil {
+				simplelogger.Errorf("control server quited: %+v", err)
+			}
+		}()
+	}
+
 	go func() {
 		siteAddr := fmt.Sprintf("%s:%d", args.DispatcherHost, args.DispatcherPort-3)
 		err := webSite.Serve(siteAddr)
@@ -253,7 +306,15 @@ func createSimulation(ctx *progctx.ProgCtx) *simulation.Simulation {
 	simcfg.DumpPackets = args.DumpPackets
 
 	dispatcherCfg := dispatcher.DefaultConfig()
+	dispatcherCfg.DumpPacketsFile = args.DumpPacketsFile
 	dispatcherCfg.NoPcap = args.NoPcap
+	dispatcherCfg.Parallel = args.Parallel && !args.Real
+	dispatcherCfg.Transport = args.Transport
+	dispatcherCfg.RadioModel = args.RadioModel
+	dispatcherCfg.CoalesceEvents = args.CoalesceEvents && !args.Real
+	dispatcherCfg.PcapFormat = args.PcapFormat
+	dispatcherCfg.PcapCompress = args.PcapCompress
+	dispatcherCfg.PcapSync = args.PcapSync
 
 	sim, err := simulation.NewSimulation(ctx, simcfg, dispatcherCfg)
 	simplelogger.FatalIfError(err)
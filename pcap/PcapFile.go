@@ -27,8 +27,12 @@
 package pcap
 
 import (
+	"bufio"
+	"compress/gzip"
 	"encoding/binary"
+	"io"
 	"os"
+	"strconv"
 )
 
 const (
@@ -39,23 +43,87 @@ const (
 
 	pcapFileHeaderSize  = 24
 	pcapFrameHeaderSize = 16
+
+	pcapngBlockSectionHeader  = 0x0A0D0D0A
+	pcapngBlockInterfaceDesc  = 0x00000001
+	pcapngBlockEnhancedPacket = 0x00000006
+	pcapngByteOrderMagic      = 0x1A2B3C4D
+	pcapngOptionInterfaceName = 2
+	pcapngOptionEndOfOptions  = 0
+
+	writeBufferSize = 256 * 1024
+)
+
+const (
+	// FormatPcap is the classic pcap format; all frames share one link layer.
+	FormatPcap = "pcap"
+	// FormatPcapng is the pcapng format; every node gets its own interface
+	// block so per-node interface IDs are recorded with each frame.
+	FormatPcapng = "pcapng"
 )
 
+type Options struct {
+	Format   string // FormatPcap (default) or FormatPcapng
+	Compress bool   // gzip-compress the output stream
+}
+
 type File struct {
-	fd *os.File
+	fd  *os.File
+	gzw *gzip.Writer
+	bw  *bufio.Writer
+	w   io.Writer
+
+	format string
+	// maps node id to the pcapng interface id written for it
+	interfaces map[int]uint32
 }
 
-func NewFile(filename string) (*File, error) {
+// FileExtension returns the canonical file name extension for the options.
+func FileExtension(opts Options) string {
+	ext := opts.Format
+	if ext == "" {
+		ext = FormatPcap
+	}
+	if opts.Compress {
+		ext += ".gz"
+	}
+	return ext
+}
+
+func NewFile(filename string, opts Options) (*File, error) {
 	fd, err := os.OpenFile(filename, os.O_CREATE|os.O_TRUNC|os.O_WRONLY, 0644)
 	if err != nil {
 		return nil, err
 	}
 
 	pf := &File{
-		fd: fd,
+		fd:     fd,
+		format: opts.Format,
+	}
+	if pf.format == "" {
+		pf.format = FormatPcap
+	}
+
+	pf.w = fd
+	if opts.Compress {
+		pf.gzw = gzip.NewWriter(fd)
+		pf.w = pf.gzw
 	}
+	pf.bw = bufio.NewWriterSize(pf.w, writeBufferSize)
+	pf.w = pf.bw
 
-	if err = pf.writeHeader(); err != nil {
+	if pf.format == FormatPcapng {
+		pf.interfaces = map[int]uint32{}
+		err = pf.writePcapngSectionHeader()
+	} else {
+		err = pf.writeHeader()
+	}
+	if err != nil {
+		_ = pf.Close()
+		return nil, err
+	}
+
+	if err = pf.Sync(); err != nil {
 		_ = pf.Close()
 		return nil, err
 	}
@@ -63,7 +131,13 @@ func NewFile(filename string) (*File, error) {
 	return pf, nil
 }
 
-func (pf *File) AppendFrame(ustime uint64, frame []byte) error {
+// AppendFrame appends one frame to the write buffer. In pcapng format the
+// frame is attributed to the interface of the given node.
+func (pf *File) AppendFrame(ustime uint64, nodeid int, frame []byte) error {
+	if pf.format == FormatPcapng {
+		return pf.appendPcapngFrame(ustime, nodeid, frame)
+	}
+
 	var header [pcapFrameHeaderSize]byte
 	sec := uint32(ustime / 1000000)
 	usec := uint32(ustime % 1000000)
@@ -72,23 +146,44 @@ func (pf *File) AppendFrame(ustime uint64, frame []byte) error {
 	binary.LittleEndian.PutUint32(header[8:12], uint32(len(frame)))
 	binary.LittleEndian.PutUint32(header[12:16], uint32(len(frame)))
 
-	var err error
-
-	_, err = pf.fd.Write(header[:])
-	if err != nil {
+	if _, err := pf.w.Write(header[:]); err != nil {
 		return err
 	}
 
-	_, err = pf.fd.Write(frame)
+	_, err := pf.w.Write(frame)
 	return err
 }
 
+// Flush writes buffered frames through to the file without forcing them to
+// stable storage.
+func (pf *File) Flush() error {
+	if err := pf.bw.Flush(); err != nil {
+		return err
+	}
+	if pf.gzw != nil {
+		return pf.gzw.Flush()
+	}
+	return nil
+}
+
 func (pf *File) Sync() error {
+	if err := pf.Flush(); err != nil {
+		return err
+	}
 	return pf.fd.Sync()
 }
 
 func (pf *File) Close() error {
-	return pf.fd.Close()
+	err := pf.bw.Flush()
+	if pf.gzw != nil {
+		if gzerr := pf.gzw.Close(); err == nil {
+			err = gzerr
+		}
+	}
+	if cerr := pf.fd.Close(); err == nil {
+		err = cerr
+	}
+	return err
 }
 
 func (pf *File) writeHeader() error {
@@ -100,8 +195,84 @@ func (pf *File) writeHeader() error {
 	binary.LittleEndian.PutUint32(header[12:16], 0)
 	binary.LittleEndian.PutUint32(header[16:20], 256)
 	binary.LittleEndian.PutUint32(header[20:24], dltIeee802154)
-	if _, err := pf.fd.Write(header[:]); err != nil {
+	_, err := pf.w.Write(header[:])
+	return err
+}
+
+func (pf *File) writePcapngSectionHeader() error {
+	var block [28]byte
+	binary.LittleEndian.PutUint32(block[:4], pcapngBlockSectionHeader)
+	binary.LittleEndian.PutUint32(block[4:8], uint32(len(block)))
+	binary.LittleEndian.PutUint32(block[8:12], pcapngByteOrderMagic)
+	binary.LittleEndian.PutUint16(block[12:14], 1) // major version
+	binary.LittleEndian.PutUint16(block[14:16], 0) // minor version
+	// section length unknown
+	binary.LittleEndian.PutUint64(block[16:24], 0xffffffffffffffff)
+	binary.LittleEndian.PutUint32(block[24:28], uint32(len(block)))
+	_, err := pf.w.Write(block[:])
+	return err
+}
+
+// interfaceId returns the pcapng interface id of the node, writing an
+// interface description block the first time the node is seen.
+func (pf *File) interfaceId(nodeid int) (uint32, error) {
+	if ifid, ok := pf.interfaces[nodeid]; ok {
+		return ifid, nil
+	}
+
+	name := []byte(interfaceName(nodeid))
+	namePadded := pad4(len(name))
+
+	blockLen := 20 + 4 + namePadded + 4 // fixed fields + name option + end of options
+	block := make([]byte, blockLen)
+	binary.LittleEndian.PutUint32(block[:4], pcapngBlockInterfaceDesc)
+	binary.LittleEndian.PutUint32(block[4:8], uint32(blockLen))
+	binary.LittleEndian.PutUint16(block[8:10], dltIeee802154)
+	binary.LittleEndian.PutUint32(block[12:16], 256) // snaplen
+	binary.LittleEndian.PutUint16(block[16:18], pcapngOptionInterfaceName)
+	binary.LittleEndian.PutUint16(block[18:20], uint16(len(name)))
+	copy(block[20:], name)
+	optEnd := 20 + namePadded
+	binary.LittleEndian.PutUint16(block[optEnd:optEnd+2], pcapngOptionEndOfOptions)
+	binary.LittleEndian.PutUint32(block[blockLen-4:], uint32(blockLen))
+
+	if _, err := pf.w.Write(block); err != nil {
+		return 0, err
+	}
+
+	ifid := uint32(len(pf.interfaces))
+	pf.interfaces[nodeid] = ifid
+	return ifid, nil
+}
+
+func (pf *File) appendPcapngFrame(ustime uint64, nodeid int, frame []byte) error {
+	ifid, err := pf.interfaceId(nodeid)
+	if err != nil {
 		return err
 	}
-	return pf.fd.Sync()
+
+	framePadded := pad4(len(frame))
+	blockLen := 32 + framePadded
+	block := make([]byte, blockLen)
+	binary.LittleEndian.PutUint32(block[:4], pcapngBlockEnhancedPacket)
+	binary.LittleEndian.PutUint32(block[4:8], uint32(blockLen))
+	binary.LittleEndian.PutUint32(block[8:12], ifid)
+	// timestamp in microseconds (default if_tsresol)
+	binary.LittleEndian.PutUint32(block[12:16], uint32(ustime>>32))
+	binary.LittleEndian.PutUint32(block[16:20], uint32(ustime))
+	binary.LittleEndian.PutUint32(block[20:24], uint32(len(frame)))
+	binary.LittleEndian.PutUint32(block[24:28], uint32(len(frame)))
+	copy(block[28:], frame)
+	binary.LittleEndian.PutUint32(block[blockLen-4:], uint32(blockLen))
+
+	_, err = pf.w.Write(block)
+	return err
+}
+
+func interfaceName(nodeid int) string {
+	return "node-" + strconv.Itoa(nodeid)
+}
+
+func pad4(n int) int {
+	return (n + 3) &^ 3
 }
@@ -27,6 +27,8 @@
 package pcap
 
 import (
+	"compress/gzip"
+	"io/ioutil"
 	"os"
 	"testing"
 
@@ -34,7 +36,7 @@ import (
 )
 
 func TestPcapFile(t *testing.T) {
-	pcap, err := NewFile("test.pcap")
+	pcap, err := NewFile("test.pcap", Options{})
 	if err != nil {
 		t.Fatal(err)
 	}
@@ -51,7 +53,7 @@ func TestPcapFile(t *testing.T) {
 	assert.True(t, pcapFileHeaderSize == getFileSize(t, "test.pcap"))
 
 	for i := 0; i < 10; i++ {
-		err = pcap.AppendFrame(0, []byte{0x0})
+		err = pcap.AppendFrame(0, 1, []byte{0x0})
 		if err != nil {
 			t.Fatal(err)
 		}
@@ -72,3 +74,68 @@ func getFileSize(t *testing.T, fp string) int {
 
 	return int(info.Size())
 }
+
+func TestPcapngFile(t *testing.T) {
+	pcap, err := NewFile("test.pcapng", Options{Format: FormatPcapng})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	defer func() {
+		_ = pcap.Close()
+	}()
+
+	// frames from two nodes get two interface description blocks but frames
+	// from the same node reuse its interface
+	for i := 0; i < 3; i++ {
+		if err = pcap.AppendFrame(uint64(i), 1+i%2, []byte{0x1, 0x2, 0x3}); err != nil {
+			t.Fatal(err)
+		}
+	}
+	if err = pcap.Sync(); err != nil {
+		t.Fatal(err)
+	}
+
+	assert.Equal(t, 2, len(pcap.interfaces))
+	assert.True(t, getFileSize(t, "test.pcapng") > 28)
+}
+
+func TestPcapCompressed(t *testing.T) {
+	pcap, err := NewFile("test.pcap.gz", Options{Compress: true})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	for i := 0; i < 10; i++ {
+		if err = pcap.AppendFrame(uint64(i), 1, []byte{0x1, 0x2, 0x3}); err != nil {
+			t.Fatal(err)
+		}
+	}
+	if err = pcap.Close(); err != nil {
+		t.Fatal(err)
+	}
+
+	fd, err := os.Open("test.pcap.gz")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer func() {
+		_ = fd.Close()
+	}()
+
+	gz, err := gzip.NewReader(fd)
+	if err != nil {
+		t.Fatal(err)
+	}
+	data, err := ioutil.ReadAll(gz)
+	if err != nil {
+		t.Fatal(err)
+	}
+	assert.Equal(t, pcapFileHeaderSize+(pcapFrameHeaderSize+3)*10, len(data))
+}
+
+func TestFileExtension(t *testing.T) {
+	assert.Equal(t, "pcap", FileExtension(Options{}))
+	assert.Equal(t, "pcapng", FileExtension(Options{Format: FormatPcapng}))
+	assert.Equal(t, "pcapng.gz", FileExtension(Options{Format: FormatPcapng, Compress: true}))
+}
@@ -30,7 +30,9 @@ import logging
 import os
 import shutil
 import signal
+import socket
 import subprocess
+import time
 from typing import List, Union, Optional, Tuple, Dict, Any, Collection
 
 import yaml
@@ -46,12 +48,20 @@ class OTNS(object):
     MAX_SIMULATE_SPEED = 1000000  # Max simulating speed
     PAUSE_SIMULATE_SPEED = 0
 
-    def __init__(self, otns_path: Optional[str] = None, otns_args: Optional[List[str]] = None):
+    def __init__(self, otns_path: Optional[str] = None, otns_args: Optional[List[str]] = None,
+                 ctrl_port: Optional[int] = None):
         self._otns_path = otns_path or self._detect_otns_path()
         self._otns_args = list(otns_args or []) + ['-autogo=false', '-web=false']
+        self._ctrl_sock = None
+        self._ctrl_rx = None
+        self._next_cmd_id = 0
+        if ctrl_port is not None:
+            self._otns_args += [f'-ctrl=localhost:{ctrl_port}']
         logging.info("otns found: %s", self._otns_path)
         self._launch_otns()
         self._closed = False
+        if ctrl_port is not None:
+            self._connect_ctrl(ctrl_port)
 
     def _launch_otns(self) -> None:
         logging.info("launching otns: %s %s", self._otns_path, ' '.join(self._otns_args))
@@ -71,6 +81,11 @@ class OTNS(object):
             return
 
         self._closed = True
+        if self._ctrl_sock is not None:
+            self._ctrl_rx.close()
+            self._ctrl_sock.close()
+            self._ctrl_sock = None
+
         logging.info("waiting for OTNS to close ...")
         self._otns.send_signal(signal.SIGTERM)
         try:
@@ -143,7 +158,88 @@ class OTNS(object):
 
         return which_otns
 
+    def _connect_ctrl(self, port: int) -> None:
+        deadline = time.time() + 10
+        while True:
+            try:
+                self._ctrl_sock = socket.create_connection(('localhost', port))
+                break
+            except ConnectionRefusedError:
+                if self._otns.poll() is not None:
+                    self._on_otns_eof()
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.1)
+
+        self._ctrl_rx = self._ctrl_sock.makefile('rb')
+        logging.info("control socket connected: localhost:%d", port)
+
+    def do_commands(self, cmds: List[str]) -> List[List[str]]:
+        """
+        Run a batch of CLI commands pipelined over the control socket.
+
+        All commands are written to the socket at once and the correlated
+        responses are read back afterwards, so the command round-trip latency
+        is paid once per batch instead of once per command. Requires the
+        control socket (pass ctrl_port to the constructor).
+
+        :param cmds: CLI commands to run, executed in order
+        :return: the output lines of each command
+        :raises OTNSCliError: for the first command that failed; the remaining
+            commands of the batch are still executed
+        """
+        if self._ctrl_sock is None:
+            raise RuntimeError("control socket not enabled, pass ctrl_port to OTNS()")
+
+        ids = []
+        req = []
+        for cmd in cmds:
+            self._next_cmd_id += 1
+            ids.append(str(self._next_cmd_id))
+            req.append(f'{self._next_cmd_id} {cmd}\n')
+            logging.info("OTNS <<< %s", cmd)
+
+        try:
+            self._ctrl_sock.sendall(''.join(req).encode('ascii'))
+        except BrokenPipeError:
+            self._on_otns_eof()
+
+        outputs = []
+        error = None
+        for cmd_id in ids:
+            prefix = cmd_id + ' '
+            output = []
+            while True:
+                line = self._ctrl_rx.readline()
+                if line == b'':
+                    self._on_otns_eof()
+
+                line = line.rstrip(b'\r\n').decode('utf-8')
+                logging.info(f"OTNS >>> {line}")
+                if not line.startswith(prefix):
+                    continue
+
+                line = line[len(prefix):]
+                if line == 'Done':
+                    break
+                elif line.startswith('Error: '):
+                    if error is None:
+                        error = OTNSCliError(line[7:])
+                    break
+
+                output.append(line)
+
+            outputs.append(output)
+
+        if error is not None:
+            raise error
+
+        return outputs
+
     def _do_command(self, cmd: str) -> List[str]:
+        if self._ctrl_sock is not None:
+            return self.do_commands([cmd])[0]
+
         logging.info("OTNS <<< %s", cmd)
         try:
             self._otns.stdin.write(cmd.encode('ascii') + b'\n')
@@ -167,7 +263,7 @@ class OTNS(object):
             output.append(line)
 
     def add(self, type: str, x: float = None, y: float = None, id=None, radio_range=None, executable=None,
-            restore=False) -> int:
+            restore=False, count=None):
         """
         Add a new node to the simulation.
 
@@ -178,8 +274,9 @@ class OTNS(object):
         :param radio_range: node radio range or None for default
         :param executable: specify the executable for the new node, or use default executable if None
         :param restore: whether the node restores network configuration from persistent storage
+        :param count: add this many nodes at once (can not be combined with id)
 
-        :return: added node ID
+        :return: added node ID, or the list of added node IDs if count is given
         """
         cmd = f'add {type}'
         if x is not None:
@@ -190,6 +287,9 @@ class OTNS(object):
         if id is not None:
             cmd += f' id {id}'
 
+        if count is not None:
+            cmd += f' count {count}'
+
         if radio_range is not None:
             cmd += f' rr {radio_range}'
 
@@ -199,7 +299,27 @@ class OTNS(object):
         if restore:
             cmd += f' restore'
 
-        return self._expect_int(self._do_command(cmd))
+        output = self._do_command(cmd)
+        if count is not None:
+            return [int(line) for line in output]
+
+        return self._expect_int(output)
+
+    def checkpoint_save(self, name: str) -> None:
+        """
+        Save a checkpoint of the formed network under the given name.
+
+        :param name: checkpoint name
+        """
+        self._do_command(f'checkpoint save {name}')
+
+    def checkpoint_load(self, name: str) -> None:
+        """
+        Restore a checkpoint into an empty simulation.
+
+        :param name: checkpoint name
+        """
+        self._do_command(f'checkpoint load {name}')
 
     def delete(self, *nodeids: int) -> None:
         """
@@ -429,6 +549,29 @@ class OTNS(object):
         output = self._do_command(cmd)
         return output
 
+    def node_cmds(self, nodeids: Collection[int], cmd: str) -> Dict[int, List[str]]:
+        """
+        Run one command on multiple nodes concurrently.
+
+        The command is issued to all nodes before the responses are gathered,
+        so the nodes execute it in parallel. A node that fails reports a
+        single "Error: ..." line as its output instead of failing the whole
+        call.
+
+        :param nodeids: target node IDs
+        :param cmd: command to execute
+
+        :return: lines of command output per node ID
+        """
+        ids = " ".join(str(nodeid) for nodeid in nodeids)
+        output = self._do_command(f'node {ids} "{cmd}"')
+        result: Dict[int, List[str]] = {nodeid: [] for nodeid in nodeids}
+        for line in output:
+            idstr, sep, rest = line.partition(': ')
+            if sep and idstr.isdigit() and int(idstr) in result:
+                result[int(idstr)].append(rest)
+        return result
+
     def get_state(self, nodeid: int) -> str:
         """
         Get node state.
@@ -0,0 +1,184 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package simulation
+
+import (
+	"encoding/json"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+
+	"github.com/openthread/ot-ns/threadconst"
+	. "github.com/openthread/ot-ns/types"
+	"github.com/pkg/errors"
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+const checkpointBaseDir = "ckpt"
+
+// checkpointNode records the configuration and position of one node; the
+// Thread state itself (dataset, child/router tables, addresses) lives in the
+// node's flash file copied next to checkpoint.json.
+type checkpointNode struct {
+	ID             NodeId `json:"id"`
+	X              int    `json:"x"`
+	Y              int    `json:"y"`
+	RadioRange     int    `json:"radio_range"`
+	IsMtd          bool   `json:"is_mtd,omitempty"`
+	IsRouter       bool   `json:"is_router,omitempty"`
+	RxOffWhenIdle  bool   `json:"rx_off_when_idle,omitempty"`
+	ExecutablePath string `json:"executable,omitempty"`
+}
+
+type checkpointInfo struct {
+	Nodes []checkpointNode `json:"nodes"`
+}
+
+// nodeFlashFile returns the path of the flash file a node process persists
+// its Thread state to.
+func (s *Simulation) nodeFlashFile(id NodeId) string {
+	portOffset := (s.cfg.DispatcherPort - threadconst.InitialDispatcherPort) / threadconst.WellKnownNodeId
+	return fmt.Sprintf("tmp/%d_%d.flash", portOffset, id)
+}
+
+// SaveCheckpoint snapshots the simulation into ckpt/<name>: every node's
+// configuration and position plus a copy of its flash file. It runs while the
+// simulation is paused, so the flash files are consistent. Simulated time and
+// in-flight frames are not saved: restored nodes resume from their persisted
+// Thread state at time zero, skipping mesh formation.
+func (s *Simulation) SaveCheckpoint(name string) error {
+	if s.cfg.Real {
+		return errors.Errorf("can not checkpoint a simulation of real devices")
+	}
+
+	dir := filepath.Join(checkpointBaseDir, name)
+	if err := os.RemoveAll(dir); err != nil {
+		return err
+	}
+	if err := os.MkdirAll(dir, 0755); err != nil {
+		return err
+	}
+
+	info := &checkpointInfo{}
+	var err error
+	s.VisitNodesInOrder(func(node *Node) {
+		if err != nil {
+			return
+		}
+
+		dn := s.d.GetNode(node.Id)
+		info.Nodes = append(info.Nodes, checkpointNode{
+			ID:             node.Id,
+			X:              dn.X,
+			Y:              dn.Y,
+			RadioRange:     node.cfg.RadioRange,
+			IsMtd:          node.cfg.IsMtd,
+			IsRouter:       node.cfg.IsRouter,
+			RxOffWhenIdle:  node.cfg.RxOffWhenIdle,
+			ExecutablePath: node.cfg.ExecutablePath,
+		})
+
+		err = copyFile(s.nodeFlashFile(node.Id), filepath.Join(dir, fmt.Sprintf("%d.flash", node.Id)))
+	})
+	if err != nil {
+		return err
+	}
+
+	data, err := json.MarshalIndent(info, "", "  ")
+	if err != nil {
+		return err
+	}
+	if err = ioutil.WriteFile(filepath.Join(dir, "checkpoint.json"), data, 0644); err != nil {
+		return err
+	}
+
+	simplelogger.Infof("saved checkpoint %s: %d nodes", name, len(info.Nodes))
+	return nil
+}
+
+// LoadCheckpoint restores a simulation saved by SaveCheckpoint. The
+// simulation must be empty; the checkpointed nodes are recreated as one batch
+// with their flash files in place, so they rejoin the saved topology without
+// going through mesh formation.
+func (s *Simulation) LoadCheckpoint(name string) error {
+	if len(s.nodes) > 0 {
+		return errors.Errorf("can not load a checkpoint into a non-empty simulation")
+	}
+
+	dir := filepath.Join(checkpointBaseDir, name)
+	data, err := ioutil.ReadFile(filepath.Join(dir, "checkpoint.json"))
+	if err != nil {
+		return errors.Wrapf(err, "checkpoint %s not found", name)
+	}
+
+	info := &checkpointInfo{}
+	if err = json.Unmarshal(data, info); err != nil {
+		return errors.Wrapf(err, "checkpoint %s is corrupted", name)
+	}
+
+	if err = os.MkdirAll("tmp", 0755); err != nil {
+		return err
+	}
+
+	cfgs := make([]*NodeConfig, 0, len(info.Nodes))
+	seen := map[NodeId]struct{}{}
+	for _, cn := range info.Nodes {
+		if _, ok := seen[cn.ID]; ok || cn.ID <= 0 {
+			return errors.Errorf("checkpoint %s is corrupted: bad node id %d", name, cn.ID)
+		}
+		seen[cn.ID] = struct{}{}
+
+		if err = copyFile(filepath.Join(dir, fmt.Sprintf("%d.flash", cn.ID)), s.nodeFlashFile(cn.ID)); err != nil {
+			return err
+		}
+
+		cfgs = append(cfgs, &NodeConfig{
+			ID:             cn.ID,
+			X:              cn.X,
+			Y:              cn.Y,
+			IsMtd:          cn.IsMtd,
+			IsRouter:       cn.IsRouter,
+			RxOffWhenIdle:  cn.RxOffWhenIdle,
+			RadioRange:     cn.RadioRange,
+			ExecutablePath: cn.ExecutablePath,
+			Restore:        true,
+		})
+	}
+
+	simplelogger.Infof("loading checkpoint %s: %d nodes", name, len(cfgs))
+	_, err = s.addNodes(cfgs)
+	return err
+}
+
+func copyFile(src, dst string) error {
+	data, err := ioutil.ReadFile(src)
+	if err != nil {
+		return err
+	}
+	return ioutil.WriteFile(dst, data, 0644)
+}
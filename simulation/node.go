@@ -40,8 +40,6 @@ import (
 	"syscall"
 	"time"
 
-	"github.com/openthread/ot-ns/threadconst"
-
 	"github.com/openthread/ot-ns/otoutfilter"
 	. "github.com/openthread/ot-ns/types"
 	"github.com/simonlingoogle/go-simplelogger"
@@ -67,8 +65,7 @@ func newNode(s *Simulation, id NodeId, cfg *NodeConfig) (*Node, error) {
 	var err error
 
 	if !cfg.Restore {
-		portOffset := (s.cfg.DispatcherPort - threadconst.InitialDispatcherPort) / threadconst.WellKnownNodeId
-		flashFile := fmt.Sprintf("tmp/%d_%d.flash", portOffset, id)
+		flashFile := s.nodeFlashFile(id)
 		if err := os.RemoveAll(flashFile); err != nil {
 			simplelogger.Errorf("Remove flash file %s failed: %+v", flashFile, err)
 		}
@@ -90,7 +87,7 @@ func newNode(s *Simulation, id NodeId, cfg *NodeConfig) (*Node, error) {
 		uartType:     NodeUartTypeUndefined,
 	}
 
-	node.virtualUartReader, node.virtualUartPipe = io.Pipe()
+	node.virtualUart = newUartPipeline(node.String())
 
 	if node.pipeIn, err = cmd.StdinPipe(); err != nil {
 		return nil, err
@@ -111,7 +108,7 @@ func newNode(s *Simulation, id NodeId, cfg *NodeConfig) (*Node, error) {
 	}
 
 	go node.lineReader(node.pipeOut, NodeUartTypeRealTime)
-	go node.lineReader(node.virtualUartReader, NodeUartTypeVirtualTime)
+	go node.lineReader(node.virtualUart, NodeUartTypeVirtualTime)
 	return node, nil
 }
 
@@ -123,32 +120,80 @@ type Node struct {
 	cmd       *exec.Cmd
 	outputErr io.Reader
 
-	pendingLines      chan string
-	pipeIn            io.WriteCloser
-	pipeOut           io.Reader
-	pipeErr           io.ReadCloser
-	virtualUartReader *io.PipeReader
-	virtualUartPipe   *io.PipeWriter
-	uartType          NodeUartType
+	pendingLines chan string
+	pipeIn       io.WriteCloser
+	pipeOut      io.Reader
+	pipeErr      io.ReadCloser
+	virtualUart  *uartPipeline
+	uartType     NodeUartType
 }
 
 func (node *Node) String() string {
 	return fmt.Sprintf("Node<%d>", node.Id)
 }
 
-func (node *Node) SetupNetworkParameters(sim *Simulation) {
-	node.SetNetworkKey(node.S.NetworkKey())
-	node.SetPanid(node.S.Panid())
-	node.SetChannel(node.S.Channel())
-}
+// setupCommands returns the ordered CLI commands that configure a preset
+// node's mode and bring it onto the configured network. In raw mode only the
+// mode configuration is included.
+func (node *Node) setupCommands(sim *Simulation) []string {
+	if node.cfg.IsRouter {
+		// routers should be full functional and rx always on
+		simplelogger.AssertFalse(node.cfg.IsMtd)
+		simplelogger.AssertFalse(node.cfg.RxOffWhenIdle)
+	}
+
+	// only MED can use RxOffWhenIdle
+	simplelogger.AssertTrue(!node.cfg.RxOffWhenIdle || node.cfg.IsMtd)
+
+	mode := ""
+	if !node.cfg.RxOffWhenIdle {
+		mode += "r"
+	}
+	if !node.cfg.IsMtd {
+		mode += "d"
+	}
+	mode += "n"
 
-func (node *Node) Start() {
-	node.IfconfigUp()
-	node.ThreadStart()
+	cmds := []string{fmt.Sprintf("mode %s", mode)}
+	if !node.cfg.IsRouter {
+		cmds = append(cmds, "routereligible disable")
+	} else {
+		cmds = append(cmds, "routerselectionjitter 1")
+	}
 
-	simplelogger.Infof("%v - started, panid=0x%04x, channel=%d, eui64=%#v, extaddr=%#v, state=%s, networkkey=%#v, mode=%v", node,
-		node.GetPanid(), node.GetChannel(), node.GetEui64(), node.GetExtAddr(), node.GetState(),
-		node.GetNetworkKey(), node.GetMode())
+	if sim.rawMode {
+		return cmds
+	}
+
+	ch := sim.Channel()
+	simplelogger.AssertTrue(11 <= ch && ch <= 26)
+	return append(cmds,
+		fmt.Sprintf("networkkey %s", sim.NetworkKey()),
+		fmt.Sprintf("panid 0x%x", sim.Panid()),
+		fmt.Sprintf("channel %d", ch),
+		"ifconfig up",
+		"thread start",
+	)
+}
+
+// fastSetup configures and starts a preset node with a single exchange: all
+// setup commands are written at once and their responses are collected
+// afterwards, instead of paying one command round trip each.
+func (node *Node) fastSetup(sim *Simulation) {
+	cmds := node.setupCommands(sim)
+	for _, cmd := range cmds {
+		node.CommandAsync(cmd)
+	}
+	for _, cmd := range cmds {
+		node.CommandCollect(cmd, DefaultCommandTimeout)
+	}
+
+	if !sim.rawMode {
+		// keep the dispatcher's per-channel index in sync so that frames are
+		// only dispatched to nodes listening on their channel
+		node.S.Dispatcher().SetNodeChannel(node.Id, uint8(sim.Channel()))
+		simplelogger.Infof("%v - started, panid=0x%04x, channel=%d", node, sim.Panid(), sim.Channel())
+	}
 }
 
 func (node *Node) IsFED() bool {
@@ -164,7 +209,7 @@ func (node *Node) Stop() {
 func (node *Node) Exit() error {
 	node.inputCommand("exit")
 	_ = node.cmd.Process.Signal(syscall.SIGTERM)
-	_ = node.virtualUartReader.Close()
+	_ = node.virtualUart.Close()
 
 	err := node.cmd.Wait()
 	node.S.Dispatcher().NotifyExit(node.Id)
@@ -203,8 +248,17 @@ func (node *Node) CommandExpectNone(cmd string, timeout time.Duration) {
 	node.expectLine(cmd, timeout)
 }
 
-func (node *Node) Command(cmd string, timeout time.Duration) []string {
+// CommandAsync issues cmd to the node without waiting for its response; the
+// response must be gathered later with CommandCollect. Issuing a command to
+// many nodes before collecting lets the node processes execute it
+// concurrently instead of one after another.
+func (node *Node) CommandAsync(cmd string) {
 	node.inputCommand(cmd)
+}
+
+// CommandCollect gathers the response of a command previously issued with
+// CommandAsync.
+func (node *Node) CommandCollect(cmd string, timeout time.Duration) []string {
 	node.expectLine(cmd, timeout)
 	output := node.expectLine(DoneOrErrorRegexp, timeout)
 
@@ -216,6 +270,11 @@ func (node *Node) Command(cmd string, timeout time.Duration) []string {
 	return output
 }
 
+func (node *Node) Command(cmd string, timeout time.Duration) []string {
+	node.CommandAsync(cmd)
+	return node.CommandCollect(cmd, timeout)
+}
+
 func (node *Node) CommandExpectString(cmd string, timeout time.Duration) string {
 	output := node.Command(cmd, timeout)
 	if len(output) != 1 {
@@ -258,6 +317,9 @@ func (node *Node) CommandExpectHex(cmd string, timeout time.Duration) int {
 func (node *Node) SetChannel(ch int) {
 	simplelogger.AssertTrue(11 <= ch && ch <= 26)
 	node.Command(fmt.Sprintf("channel %d", ch), DefaultCommandTimeout)
+	// keep the dispatcher's per-channel index in sync so that frames are only
+	// dispatched to nodes listening on their channel
+	node.S.Dispatcher().SetNodeChannel(node.Id, uint8(ch))
 }
 
 func (node *Node) GetChannel() int {
@@ -699,36 +761,11 @@ func (node *Node) DumpStat() string {
 	return fmt.Sprintf("extaddr %016x, addr %04x, state %-6s", node.GetExtAddr(), node.GetRloc16(), node.GetState())
 }
 
-func (node *Node) setupMode() {
-	if node.cfg.IsRouter {
-		// routers should be full functional and rx always on
-		simplelogger.AssertFalse(node.cfg.IsMtd)
-		simplelogger.AssertFalse(node.cfg.RxOffWhenIdle)
-	}
-
-	// only MED can use RxOffWhenIdle
-	simplelogger.AssertTrue(!node.cfg.RxOffWhenIdle || node.cfg.IsMtd)
-
-	mode := ""
-	if !node.cfg.RxOffWhenIdle {
-		mode += "r"
-	}
-	if !node.cfg.IsMtd {
-		mode += "d"
-	}
-	mode += "n"
-
-	node.SetMode(mode)
-
-	if !node.cfg.IsRouter {
-		node.RouterEligibleDisable()
-	} else {
-		node.SetRouterSelectionJitter(1)
-	}
-}
-
+// onUartWrite feeds virtual-time UART output into the node's buffered
+// pipeline; data is copied there, so it never blocks the dispatcher and the
+// caller may reuse the slice.
 func (node *Node) onUartWrite(data []byte) {
-	_, _ = node.virtualUartPipe.Write(data)
+	_, _ = node.virtualUart.Write(data)
 }
 
 func (node *Node) detectVirtualTimeUART() {
@@ -29,6 +29,8 @@ package simulation
 import (
 	"os"
 	"sort"
+	"sync"
+	"syscall"
 	"time"
 
 	"github.com/openthread/ot-ns/progctx"
@@ -108,14 +110,92 @@ func (s *Simulation) AddNode(cfg *NodeConfig) (*Node, error) {
 
 	node.detectVirtualTimeUART()
 
-	node.setupMode()
+	node.fastSetup(s)
 
-	if !s.rawMode {
-		node.SetupNetworkParameters(s)
-		node.Start()
+	return node, nil
+}
+
+// AddNodes creates count nodes based on cfg. All node processes are forked
+// concurrently and registered with the dispatcher as one batch, so the waits
+// for their extended addresses overlap; this is much faster than calling
+// AddNode repeatedly when standing up large topologies.
+func (s *Simulation) AddNodes(cfg *NodeConfig, count int) ([]*Node, error) {
+	if cfg == nil {
+		cfg = DefaultNodeConfig()
 	}
 
-	return node, nil
+	if cfg.ID > 0 {
+		return nil, errors.Errorf("bulk add can not use an explicit node id")
+	}
+
+	// assign node ids first, then fork all node processes concurrently; the
+	// id cursor only moves forward so ids within the batch never collide
+	cfgs := make([]*NodeConfig, count)
+	nodeid := 0
+	for i := range cfgs {
+		nodeid++
+		for s.nodes[nodeid] != nil {
+			nodeid++
+		}
+
+		nodeCfg := *cfg
+		nodeCfg.ID = nodeid
+		cfgs[i] = &nodeCfg
+	}
+
+	simplelogger.Infof("simulation:CtrlAddNodes: %d nodes, %+v, rawMode=%v", count, cfg, s.rawMode)
+
+	return s.addNodes(cfgs)
+}
+
+// addNodes creates one node per config as a batch; the configs must carry
+// distinct, unused node ids.
+func (s *Simulation) addNodes(cfgs []*NodeConfig) ([]*Node, error) {
+	count := len(cfgs)
+	nodes := make([]*Node, count)
+	errs := make([]error, count)
+
+	var wg sync.WaitGroup
+	for i := range cfgs {
+		wg.Add(1)
+		go func(i int) {
+			defer wg.Done()
+			nodes[i], errs[i] = newNode(s, cfgs[i].ID, cfgs[i])
+		}(i)
+	}
+	wg.Wait()
+
+	for i, err := range errs {
+		if err == nil {
+			continue
+		}
+
+		simplelogger.Errorf("simulation add node failed: %v", err)
+		for _, node := range nodes {
+			// nodes of a failed batch are not set up yet, so just terminate
+			// their processes
+			if node != nil {
+				_ = node.cmd.Process.Signal(syscall.SIGTERM)
+			}
+		}
+		return nil, err
+	}
+
+	// register the whole batch with the dispatcher, then wait for all of them
+	nodeids := make([]NodeId, count)
+	for i, node := range nodes {
+		s.nodes[node.Id] = node
+		s.d.AddNodeNoWait(node.Id, cfgs[i].X, cfgs[i].Y, cfgs[i].RadioRange)
+		nodeids[i] = node.Id
+	}
+	s.d.WaitNodesReady(nodeids)
+
+	for _, node := range nodes {
+		node.detectVirtualTimeUART()
+		node.fastSetup(s)
+	}
+
+	return nodes, nil
 }
 
 func (s *Simulation) genNodeId() NodeId {
@@ -140,6 +220,45 @@ func (s *Simulation) Nodes() map[NodeId]*Node {
 	return s.nodes
 }
 
+// CommandOnNodes runs cmd on all of the given nodes concurrently: the command
+// is first issued to every node, then the responses are gathered per node.
+// The node processes execute the command in parallel, so a network-wide state
+// query takes roughly one command round trip instead of one per node.
+// Outputs and errors are returned per node id; a failure on one node does not
+// prevent gathering the responses of the others.
+func (s *Simulation) CommandOnNodes(nodeids []NodeId, cmd string, timeout time.Duration) (map[NodeId][]string, map[NodeId]error) {
+	outputs := make(map[NodeId][]string, len(nodeids))
+	errs := map[NodeId]error{}
+
+	issued := make([]NodeId, 0, len(nodeids))
+	for _, nodeid := range nodeids {
+		node := s.nodes[nodeid]
+		if node == nil {
+			errs[nodeid] = errors.Errorf("node %d not found", nodeid)
+			continue
+		}
+
+		node.CommandAsync(cmd)
+		issued = append(issued, nodeid)
+	}
+
+	for _, nodeid := range issued {
+		node := s.nodes[nodeid]
+
+		func() {
+			defer func() {
+				if err := recover(); err != nil {
+					errs[nodeid] = errors.Errorf("%+v", err)
+				}
+			}()
+
+			outputs[nodeid] = node.CommandCollect(cmd, timeout)
+		}()
+	}
+
+	return outputs, errs
+}
+
 func (s *Simulation) NetworkKey() string {
 	return s.cfg.NetworkKey
 }
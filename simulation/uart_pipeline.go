@@ -0,0 +1,155 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package simulation
+
+import (
+	"io"
+	"sync"
+
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+const (
+	// uartChunkSize is the capacity of the pooled buffers that UART writes
+	// are copied into.
+	uartChunkSize = 4096
+	// uartPipelineBudget bounds the bytes buffered per node; writes beyond it
+	// are dropped and accounted rather than backpressuring the writer.
+	uartPipelineBudget = 256 * 1024
+)
+
+// uartChunkPool pools chunk buffers across all nodes, so that bulk UART
+// output does not allocate per write.
+var uartChunkPool = sync.Pool{
+	New: func() interface{} {
+		return make([]byte, 0, uartChunkSize)
+	},
+}
+
+// uartPipeline is a buffered replacement for the io.Pipe that carried a
+// node's virtual-time UART output to its line reader. Write copies the data
+// into pooled chunks and never blocks, so a line reader that falls behind on
+// bulk output (scan tables, network diagnostics, OT debug logs) cannot
+// backpressure the dispatcher through UART events. When the per-node byte
+// budget is exhausted the write is dropped and counted instead.
+type uartPipeline struct {
+	name string
+
+	mu      sync.Mutex
+	cond    *sync.Cond
+	chunks  [][]byte
+	readOff int // read offset into chunks[0]
+	size    int
+	dropped uint64
+	closed  bool
+}
+
+func newUartPipeline(name string) *uartPipeline {
+	p := &uartPipeline{name: name}
+	p.cond = sync.NewCond(&p.mu)
+	return p
+}
+
+// Write copies data into the pipeline. It never blocks; data beyond the byte
+// budget is dropped and accounted.
+func (p *uartPipeline) Write(data []byte) (int, error) {
+	total := len(data)
+
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if p.closed {
+		return 0, io.ErrClosedPipe
+	}
+
+	if p.size+total > uartPipelineBudget {
+		p.dropped += uint64(total)
+		if p.dropped%uint64(uartPipelineBudget) < uint64(total) {
+			simplelogger.Warnf("%s - UART pipeline full, %d bytes dropped so far", p.name, p.dropped)
+		}
+		return total, nil
+	}
+
+	for len(data) > 0 {
+		// top up the newest chunk before taking a fresh one from the pool
+		if n := len(p.chunks); n > 0 && len(p.chunks[n-1]) < cap(p.chunks[n-1]) {
+			chunk := p.chunks[n-1]
+			c := copy(chunk[len(chunk):cap(chunk)], data)
+			p.chunks[n-1] = chunk[:len(chunk)+c]
+			data = data[c:]
+			p.size += c
+			continue
+		}
+
+		p.chunks = append(p.chunks, uartChunkPool.Get().([]byte)[:0])
+	}
+
+	p.cond.Signal()
+	return total, nil
+}
+
+// Read blocks until data is available or the pipeline is closed, then copies
+// out as much buffered data as fits in buf, recycling drained chunks.
+func (p *uartPipeline) Read(buf []byte) (int, error) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	for p.size == 0 && !p.closed {
+		p.cond.Wait()
+	}
+	if p.size == 0 {
+		return 0, io.EOF
+	}
+
+	n := 0
+	for n < len(buf) && len(p.chunks) > 0 {
+		chunk := p.chunks[0]
+		c := copy(buf[n:], chunk[p.readOff:])
+		n += c
+		p.readOff += c
+		p.size -= c
+
+		if p.readOff == len(chunk) {
+			p.chunks[0] = nil
+			p.chunks = p.chunks[1:]
+			p.readOff = 0
+			uartChunkPool.Put(chunk[:0]) //nolint:staticcheck
+		}
+	}
+
+	return n, nil
+}
+
+// Close wakes the reader; buffered data can still be drained before EOF.
+func (p *uartPipeline) Close() error {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	p.closed = true
+	p.cond.Broadcast()
+	return nil
+}
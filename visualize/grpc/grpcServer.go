@@ -31,6 +31,8 @@ import (
 	"net"
 	"time"
 
+	"github.com/pkg/errors"
+
 	"github.com/simonlingoogle/go-simplelogger"
 
 	pb "github.com/openthread/ot-ns/visualize/grpc/pb"
@@ -38,6 +40,10 @@ import (
 	"google.golang.org/grpc"
 )
 
+// errStreamBroken indicates that the client stopped accepting events or fell
+// too far behind the state changes of the simulation.
+var errStreamBroken = errors.New("visualize stream broken")
+
 type grpcServer struct {
 	vis                *grpcVisualizer
 	server             *grpc.Server
@@ -60,6 +66,9 @@ func (gs *grpcServer) Visualize(req *pb.VisualizeRequest, stream pb.VisualizeGrp
 	err = gs.prepareStream(gstream)
 	if err != nil {
 		gs.vis.Unlock()
+		// the dispose defer is not installed yet; close the stream here so
+		// its send goroutine does not leak
+		gstream.close()
 		goto exit
 	}
 
@@ -74,10 +83,10 @@ func (gs *grpcServer) Visualize(req *pb.VisualizeRequest, stream pb.VisualizeGrp
 	for {
 		select {
 		case <-heartbeatTicker.C:
-			err = stream.Send(heartbeatEvent)
-			if err != nil {
-				goto exit
-			}
+			gstream.enqueue(heartbeatEvent, true)
+		case <-gstream.brokenChan:
+			err = errStreamBroken
+			goto exit
 		case <-contextDone:
 			err = stream.Context().Err()
 			goto exit
@@ -105,7 +114,7 @@ func (gs *grpcServer) Run() error {
 
 func (gs *grpcServer) SendEvent(event *pb.VisualizeEvent, trivial bool) {
 	for stream := range gs.visualizingStreams {
-		_ = stream.Send(event)
+		stream.enqueue(event, trivial)
 	}
 }
 
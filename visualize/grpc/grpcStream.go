@@ -26,18 +26,131 @@
 
 package visualize_grpc
 
-import pb "github.com/openthread/ot-ns/visualize/grpc/pb"
+import (
+	"sync"
+	"time"
 
+	pb "github.com/openthread/ot-ns/visualize/grpc/pb"
+)
+
+const (
+	// streamQueueSize bounds how many events may be pending per client before
+	// the client is considered too slow.
+	streamQueueSize = 4096
+	// streamFlushInterval is the length of one batching time slice: queued
+	// events are sent to the client in one burst per slice.
+	streamFlushInterval = 25 * time.Millisecond
+	// maxClientSendEventsPerSecond caps the frame-animation (Send) events
+	// delivered per client; excess ones within a slice are dropped. State
+	// changing events are never dropped.
+	maxClientSendEventsPerSecond = 2000
+
+	sendEventsPerFlush = int(maxClientSendEventsPerSecond * streamFlushInterval / time.Second)
+)
+
+// grpcStream batches the visualization events of one client: events are
+// enqueued without blocking the dispatcher and a per-stream goroutine flushes
+// them in time slices, dropping superseded trivial updates and rate limiting
+// frame animations. A client that can not keep up with state changes is
+// disconnected so it reconnects and receives a fresh full state.
 type grpcStream struct {
 	pb.VisualizeGrpcService_VisualizeServer
+
+	pendingChan chan *pb.VisualizeEvent
+	brokenChan  chan struct{}
+	brokenOnce  sync.Once
+}
+
+// enqueue queues one event for sending. Trivial events are dropped when the
+// queue is full; a full queue on a non-trivial event breaks the stream.
+func (gst *grpcStream) enqueue(event *pb.VisualizeEvent, trivial bool) {
+	select {
+	case <-gst.brokenChan:
+		return
+	default:
+	}
+
+	select {
+	case gst.pendingChan <- event:
+	case <-gst.brokenChan:
+	default:
+		if trivial {
+			return
+		}
+		gst.markBroken()
+	}
+}
+
+func (gst *grpcStream) markBroken() {
+	gst.brokenOnce.Do(func() {
+		close(gst.brokenChan)
+	})
 }
 
 func (gst *grpcStream) close() {
+	gst.markBroken()
+}
+
+func (gst *grpcStream) sendRoutine() {
+	ticker := time.NewTicker(streamFlushInterval)
+	defer ticker.Stop()
+
+	var batch []*pb.VisualizeEvent
+	for {
+		select {
+		case event := <-gst.pendingChan:
+			batch = append(batch, event)
+		case <-ticker.C:
+			if err := gst.flush(batch); err != nil {
+				gst.markBroken()
+				return
+			}
+			batch = batch[:0]
+		case <-gst.brokenChan:
+			return
+		}
+	}
+}
+
+// flush sends one time slice worth of events: only the last AdvanceTime of
+// the slice is kept, and frame animations beyond the per-slice budget are
+// dropped.
+func (gst *grpcStream) flush(batch []*pb.VisualizeEvent) error {
+	lastAdvanceTime := -1
+	for i, event := range batch {
+		if _, ok := event.Type.(*pb.VisualizeEvent_AdvanceTime); ok {
+			lastAdvanceTime = i
+		}
+	}
+
+	sends := 0
+	for i, event := range batch {
+		switch event.Type.(type) {
+		case *pb.VisualizeEvent_AdvanceTime:
+			if i != lastAdvanceTime {
+				continue
+			}
+		case *pb.VisualizeEvent_Send:
+			sends++
+			if sends > sendEventsPerFlush {
+				continue
+			}
+		}
+
+		if err := gst.VisualizeGrpcService_VisualizeServer.Send(event); err != nil {
+			return err
+		}
+	}
+
+	return nil
 }
 
 func newGrpcStream(stream pb.VisualizeGrpcService_VisualizeServer) *grpcStream {
 	gst := &grpcStream{
 		VisualizeGrpcService_VisualizeServer: stream,
+		pendingChan:                          make(chan *pb.VisualizeEvent, streamQueueSize),
+		brokenChan:                           make(chan struct{}),
 	}
+	go gst.sendRoutine()
 	return gst
 }
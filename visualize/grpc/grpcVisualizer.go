@@ -325,8 +325,15 @@ func (gv *grpcVisualizer) SetTitle(titleInfo visualize.TitleInfo) {
 }
 
 func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
+	return gv.sendState(stream.Send)
+}
+
+// sendState emits the sequence of events that reproduces the current
+// visualization state, both to prepare newly attached streams and to build
+// replay keyframes.
+func (gv *grpcVisualizer) sendState(send func(*pb.VisualizeEvent) error) error {
 	// set network info
-	if err := stream.Send(&pb.VisualizeEvent{Type: &pb.VisualizeEvent_SetNetworkInfo{SetNetworkInfo: &pb.SetNetworkInfoEvent{
+	if err := send(&pb.VisualizeEvent{Type: &pb.VisualizeEvent_SetNetworkInfo{SetNetworkInfo: &pb.SetNetworkInfoEvent{
 		Real:    gv.f.networkInfo.Real,
 		Version: gv.f.networkInfo.Version,
 		Commit:  gv.f.networkInfo.Commit,
@@ -335,13 +342,13 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 	}
 	// show demo legend if necessary
 	if gv.showDemoLegendEvent != nil {
-		if err := stream.Send(gv.showDemoLegendEvent); err != nil {
+		if err := send(gv.showDemoLegendEvent); err != nil {
 			return err
 		}
 	}
 
 	// set speed
-	if err := stream.Send(&pb.VisualizeEvent{
+	if err := send(&pb.VisualizeEvent{
 		Type: &pb.VisualizeEvent_SetSpeed{SetSpeed: &pb.SetSpeedEvent{
 			Speed: gv.f.speed,
 		}},
@@ -350,7 +357,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 	}
 	// set title
 	if gv.f.titleInfo.Title != "" {
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_SetTitle{SetTitle: &pb.SetTitleEvent{
 				Title:    gv.f.titleInfo.Title,
 				X:        int32(gv.f.titleInfo.X),
@@ -362,7 +369,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 		}
 	}
 	// advance time
-	if err := stream.Send(&pb.VisualizeEvent{
+	if err := send(&pb.VisualizeEvent{
 		Type: &pb.VisualizeEvent_AdvanceTime{AdvanceTime: &pb.AdvanceTimeEvent{
 			Ts:    gv.f.curTime,
 			Speed: gv.f.curSpeed,
@@ -380,7 +387,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 			RadioRange: int32(node.radioRange),
 		}}}
 
-		if err := stream.Send(addNodeEvent); err != nil {
+		if err := send(addNodeEvent); err != nil {
 			return err
 		}
 	}
@@ -388,7 +395,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 	// draw node attributes
 	for nodeid, node := range gv.f.nodes {
 		// extaddr
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_OnExtAddrChange{OnExtAddrChange: &pb.OnExtAddrChangeEvent{
 				NodeId:  int32(nodeid),
 				ExtAddr: node.extaddr,
@@ -397,7 +404,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 			return err
 		}
 		// rloc16
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_SetNodeRloc16{SetNodeRloc16: &pb.SetNodeRloc16Event{
 				NodeId: int32(nodeid),
 				Rloc16: uint32(node.rloc16),
@@ -406,7 +413,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 			return err
 		}
 		// role
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_SetNodeRole{SetNodeRole: &pb.SetNodeRoleEvent{
 				NodeId: int32(nodeid),
 				Role:   pb.OtDeviceRole(node.role),
@@ -415,7 +422,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 			return err
 		}
 		// mode
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_SetNodeMode{SetNodeMode: &pb.SetNodeModeEvent{
 				NodeId: int32(nodeid),
 				NodeMode: &pb.NodeMode{
@@ -428,7 +435,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 			return err
 		}
 		// partition id
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_SetNodePartitionId{SetNodePartitionId: &pb.SetNodePartitionIdEvent{
 				NodeId:      int32(nodeid),
 				PartitionId: node.partitionId,
@@ -437,7 +444,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 			return err
 		}
 		// parent
-		if err := stream.Send(&pb.VisualizeEvent{
+		if err := send(&pb.VisualizeEvent{
 			Type: &pb.VisualizeEvent_SetParent{SetParent: &pb.SetParentEvent{
 				NodeId:  int32(nodeid),
 				ExtAddr: node.parent,
@@ -448,7 +455,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 
 		// child table
 		for extaddr := range node.childTable {
-			if err := stream.Send(&pb.VisualizeEvent{
+			if err := send(&pb.VisualizeEvent{
 				Type: &pb.VisualizeEvent_AddChildTable{AddChildTable: &pb.AddChildTableEvent{
 					NodeId:  int32(nodeid),
 					ExtAddr: extaddr,
@@ -459,7 +466,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 		}
 		// router table
 		for extaddr := range node.routerTable {
-			if err := stream.Send(&pb.VisualizeEvent{
+			if err := send(&pb.VisualizeEvent{
 				Type: &pb.VisualizeEvent_AddRouterTable{AddRouterTable: &pb.AddRouterTableEvent{
 					NodeId:  int32(nodeid),
 					ExtAddr: extaddr,
@@ -470,7 +477,7 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 		}
 		// node fail
 		if node.failed {
-			if err := stream.Send(&pb.VisualizeEvent{
+			if err := send(&pb.VisualizeEvent{
 				Type: &pb.VisualizeEvent_OnNodeFail{OnNodeFail: &pb.OnNodeFailEvent{
 					NodeId: int32(nodeid),
 				}},
@@ -486,10 +493,25 @@ func (gv *grpcVisualizer) prepareStream(stream *grpcStream) error {
 func (gv *grpcVisualizer) AddVisualizationEvent(event *pb.VisualizeEvent, trivial bool) {
 	if gv.replay != nil {
 		gv.replay.Append(event, trivial)
+		if gv.replay.NeedKeyframe() {
+			gv.appendReplayKeyframe()
+		}
 	}
 	gv.server.SendEvent(event, trivial)
 }
 
+// appendReplayKeyframe snapshots the current visualization state into the
+// replay file so that a reader can seek to it without replaying from the
+// beginning. The caller must hold gv.Lock.
+func (gv *grpcVisualizer) appendReplayKeyframe() {
+	var events []*pb.VisualizeEvent
+	_ = gv.sendState(func(event *pb.VisualizeEvent) error {
+		events = append(events, event)
+		return nil
+	})
+	gv.replay.AppendKeyframe(events)
+}
+
 func NewGrpcVisualizer(address string, replayFn string) visualize.Visualizer {
 	gsv := &grpcVisualizer{
 		simctrl: nil,
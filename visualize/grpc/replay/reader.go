@@ -0,0 +1,265 @@
+package replay
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/binary"
+	"errors"
+	"io"
+	"os"
+	"sort"
+	"syscall"
+
+	visualize_grpc_pb "github.com/openthread/ot-ns/visualize/grpc/pb"
+	"google.golang.org/protobuf/proto"
+)
+
+var errInvalidReplayFile = errors.New("not a binary replay file")
+
+// Reader reads binary replay files written by Replay. The keyframe index in
+// the file footer allows seeking to a timestamp without replaying from the
+// beginning; files without a footer (e.g. from an aborted simulation) are
+// still readable linearly.
+type Reader struct {
+	f       *os.File
+	r       *bufio.Reader
+	pos     uint64
+	dataEnd uint64
+	index   []keyframeIndexEntry
+
+	// data holds the memory-mapped file contents; records are then sliced
+	// directly out of the mapping and seeking is a cursor assignment, so
+	// large captures need not be read into memory. nil when mapping failed,
+	// in which case buffered file reads are used instead.
+	data []byte
+
+	// emit (rather than skip) the snapshot of the next keyframe record; set
+	// after seeking to a keyframe
+	emitKeyframe bool
+}
+
+// IsBinaryReplay reports whether filename starts with the binary replay file
+// magic. Files written by older versions are prototext lines and do not.
+func IsBinaryReplay(filename string) bool {
+	f, err := os.Open(filename)
+	if err != nil {
+		return false
+	}
+	defer f.Close()
+
+	magic := make([]byte, len(fileMagic))
+	if _, err := io.ReadFull(f, magic); err != nil {
+		return false
+	}
+
+	return bytes.Equal(magic, fileMagic)
+}
+
+func NewReader(filename string) (*Reader, error) {
+	f, err := os.Open(filename)
+	if err != nil {
+		return nil, err
+	}
+
+	magic := make([]byte, len(fileMagic))
+	if _, err := io.ReadFull(f, magic); err != nil {
+		_ = f.Close()
+		return nil, err
+	}
+	if !bytes.Equal(magic, fileMagic) {
+		_ = f.Close()
+		return nil, errInvalidReplayFile
+	}
+
+	r := &Reader{f: f}
+	r.mmap()
+	r.readIndex()
+
+	if err := r.seek(uint64(len(fileMagic))); err != nil {
+		_ = f.Close()
+		return nil, err
+	}
+
+	return r, nil
+}
+
+// mmap maps the file read-only; on failure the reader silently falls back to
+// buffered file reads.
+func (r *Reader) mmap() {
+	fi, err := r.f.Stat()
+	if err != nil || fi.Size() == 0 {
+		return
+	}
+
+	data, err := syscall.Mmap(int(r.f.Fd()), 0, int(fi.Size()), syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return
+	}
+	r.data = data
+}
+
+func (r *Reader) Close() error {
+	if r.data != nil {
+		_ = syscall.Munmap(r.data)
+		r.data = nil
+	}
+	return r.f.Close()
+}
+
+// ReadEntry returns the next replay entry, or io.EOF at the end of the file.
+// Keyframe snapshots are skipped during linear reading because they duplicate
+// state already established by the preceding entries.
+func (r *Reader) ReadEntry() (*visualize_grpc_pb.ReplayEntry, error) {
+	for {
+		if r.pos >= r.dataEnd {
+			return nil, io.EOF
+		}
+
+		recordType, payload, err := r.readRecord()
+		if err != nil {
+			return nil, err
+		}
+
+		if recordType == recordTypeKeyframe {
+			count := binary.LittleEndian.Uint32(payload)
+			if r.emitKeyframe {
+				r.emitKeyframe = false
+				continue
+			}
+
+			for i := uint32(0); i < count; i++ {
+				if _, _, err := r.readRecord(); err != nil {
+					return nil, err
+				}
+			}
+			continue
+		}
+
+		entry := &visualize_grpc_pb.ReplayEntry{}
+		if err := proto.Unmarshal(payload, entry); err != nil {
+			return nil, err
+		}
+
+		return entry, nil
+	}
+}
+
+// SeekTimestamp repositions the reader at the last keyframe at or before the
+// given timestamp, so that reading forward replays the snapshot followed by
+// the subsequent entries. Without a usable index it rewinds to the beginning.
+func (r *Reader) SeekTimestamp(timestamp uint64) error {
+	offset := uint64(len(fileMagic))
+	emit := false
+
+	i := sort.Search(len(r.index), func(i int) bool {
+		return r.index[i].Timestamp > timestamp
+	}) - 1
+	if i >= 0 {
+		offset = r.index[i].Offset
+		emit = true
+	}
+
+	if err := r.seek(offset); err != nil {
+		return err
+	}
+	r.emitKeyframe = emit
+
+	return nil
+}
+
+func (r *Reader) seek(offset uint64) error {
+	if r.data == nil {
+		if _, err := r.f.Seek(int64(offset), io.SeekStart); err != nil {
+			return err
+		}
+
+		if r.r == nil {
+			r.r = bufio.NewReader(r.f)
+		} else {
+			r.r.Reset(r.f)
+		}
+	}
+	r.pos = offset
+	r.emitKeyframe = false
+
+	return nil
+}
+
+func (r *Reader) readRecord() (recordType byte, payload []byte, err error) {
+	if r.data != nil {
+		if r.pos+recordHeaderSize > r.dataEnd {
+			return 0, nil, io.ErrUnexpectedEOF
+		}
+		recordType = r.data[r.pos]
+		length := uint64(binary.LittleEndian.Uint32(r.data[r.pos+1:]))
+		if r.pos+recordHeaderSize+length > r.dataEnd {
+			return 0, nil, io.ErrUnexpectedEOF
+		}
+		payload = r.data[r.pos+recordHeaderSize : r.pos+recordHeaderSize+length]
+		r.pos += recordHeaderSize + length
+		return recordType, payload, nil
+	}
+
+	var header [recordHeaderSize]byte
+	if _, err = io.ReadFull(r.r, header[:]); err != nil {
+		return 0, nil, err
+	}
+
+	recordType = header[0]
+	payload = make([]byte, binary.LittleEndian.Uint32(header[1:]))
+	if _, err = io.ReadFull(r.r, payload); err != nil {
+		return 0, nil, err
+	}
+
+	r.pos += uint64(recordHeaderSize + len(payload))
+	return recordType, payload, nil
+}
+
+// readIndex parses the keyframe index footer. An absent or invalid footer is
+// not an error: the index stays empty and the whole file is treated as data.
+func (r *Reader) readIndex() {
+	fi, err := r.f.Stat()
+	if err != nil {
+		return
+	}
+	size := uint64(fi.Size())
+	r.dataEnd = size
+
+	footerLen := uint64(4 + len(indexMagic))
+	if size < uint64(len(fileMagic))+footerLen {
+		return
+	}
+
+	footer := make([]byte, footerLen)
+	if _, err := r.f.ReadAt(footer, int64(size-footerLen)); err != nil {
+		return
+	}
+	if !bytes.Equal(footer[4:], indexMagic) {
+		return
+	}
+
+	indexLen := uint64(binary.LittleEndian.Uint32(footer[:4]))
+	if indexLen+footerLen > size-uint64(len(fileMagic)) {
+		return
+	}
+
+	indexStart := size - footerLen - indexLen
+	buf := make([]byte, indexLen)
+	if _, err := r.f.ReadAt(buf, int64(indexStart)); err != nil {
+		return
+	}
+
+	count := binary.LittleEndian.Uint32(buf[:4])
+	if uint64(count)*16+4 != indexLen {
+		return
+	}
+
+	index := make([]keyframeIndexEntry, count)
+	for i := range index {
+		index[i].Timestamp = binary.LittleEndian.Uint64(buf[4+i*16:])
+		index[i].Offset = binary.LittleEndian.Uint64(buf[4+i*16+8:])
+	}
+
+	r.index = index
+	r.dataEnd = indexStart
+}
@@ -2,40 +2,72 @@ package replay
 
 import (
 	"bufio"
+	"encoding/binary"
 	"os"
 	"time"
 
 	visualize_grpc_pb "github.com/openthread/ot-ns/visualize/grpc/pb"
 	"github.com/simonlingoogle/go-simplelogger"
-	"google.golang.org/protobuf/encoding/prototext"
+	"google.golang.org/protobuf/proto"
+)
+
+// Replay files are binary: an 8-byte file magic followed by records of the
+// form [1-byte type][4-byte LE payload length][payload]. Entry records carry
+// one binary-marshaled ReplayEntry. A keyframe record carries the number of
+// entry records that follow it and form a full snapshot of the visualization
+// state; a footer index of (timestamp, keyframe offset) pairs allows a reader
+// to seek to any timestamp without replaying from the beginning.
+const (
+	recordTypeEntry    = 0
+	recordTypeKeyframe = 1
+
+	recordHeaderSize = 5
+
+	// a keyframe snapshot is inserted roughly every this many entries
+	keyframeEntryInterval = 10000
 )
 
 var (
-	marshalOptions = prototext.MarshalOptions{
-		Multiline: false,
-	}
+	fileMagic  = []byte("OTNSRPL1")
+	indexMagic = []byte("OTNSRIX1")
 )
 
+type keyframeIndexEntry struct {
+	Timestamp uint64
+	Offset    uint64
+}
+
+type replayItem struct {
+	entry    *visualize_grpc_pb.ReplayEntry
+	keyframe []*visualize_grpc_pb.ReplayEntry
+}
+
 type Replay struct {
 	f              *os.File
 	fileWriter     *bufio.Writer
-	pendingChan    chan *visualize_grpc_pb.ReplayEntry
+	pendingChan    chan replayItem
 	fileWriterDone chan struct{}
 	beginTime      time.Time
+
+	entriesSinceKeyframe int
+
+	// written offset and keyframe index, owned by fileWriterRoutine
+	offset uint64
+	index  []keyframeIndexEntry
 }
 
 func (rep *Replay) Append(event *visualize_grpc_pb.VisualizeEvent, trivial bool) {
-	timestamp := time.Since(rep.beginTime) / time.Microsecond
 	entry := &visualize_grpc_pb.ReplayEntry{
 		Event:     event,
-		Timestamp: uint64(timestamp),
+		Timestamp: rep.timestamp(),
 	}
+	rep.entriesSinceKeyframe++
 
 	if !trivial {
-		rep.pendingChan <- entry
+		rep.pendingChan <- replayItem{entry: entry}
 	} else {
 		select {
-		case rep.pendingChan <- entry:
+		case rep.pendingChan <- replayItem{entry: entry}:
 			break
 		default:
 			simplelogger.Warnf("replay generation routine is busy, dropping trivial events ...")
@@ -44,6 +76,36 @@ func (rep *Replay) Append(event *visualize_grpc_pb.VisualizeEvent, trivial bool)
 	}
 }
 
+// NeedKeyframe reports whether enough entries have accumulated that the
+// caller should provide a new state snapshot via AppendKeyframe.
+func (rep *Replay) NeedKeyframe() bool {
+	return rep.entriesSinceKeyframe >= keyframeEntryInterval
+}
+
+// AppendKeyframe appends a full snapshot of the visualization state. The
+// snapshot must reflect all previously appended events.
+func (rep *Replay) AppendKeyframe(events []*visualize_grpc_pb.VisualizeEvent) {
+	if len(events) == 0 {
+		return
+	}
+
+	timestamp := rep.timestamp()
+	entries := make([]*visualize_grpc_pb.ReplayEntry, len(events))
+	for i, event := range events {
+		entries[i] = &visualize_grpc_pb.ReplayEntry{
+			Event:     event,
+			Timestamp: timestamp,
+		}
+	}
+
+	rep.entriesSinceKeyframe = 0
+	rep.pendingChan <- replayItem{keyframe: entries}
+}
+
+func (rep *Replay) timestamp() uint64 {
+	return uint64(time.Since(rep.beginTime) / time.Microsecond)
+}
+
 func (rep *Replay) Close() {
 	close(rep.pendingChan)
 	<-rep.fileWriterDone
@@ -62,25 +124,94 @@ func (rep *Replay) fileWriterRoutine() {
 
 	defer rep.f.Close()
 
-	for e := range rep.pendingChan {
-		var data []byte
+	if err = rep.writeRaw(fileMagic); err != nil {
+		return
+	}
 
-		if data, err = marshalOptions.Marshal(e); err != nil {
-			break
+	for item := range rep.pendingChan {
+		if item.keyframe != nil {
+			err = rep.writeKeyframe(item.keyframe)
+		} else {
+			err = rep.writeEntry(item.entry)
 		}
-
-		if _, err = rep.fileWriter.Write(data); err != nil {
-			break
+		if err != nil {
+			return
 		}
+	}
 
-		if _, err = rep.fileWriter.Write([]byte{'\n'}); err != nil {
-			break
-		}
+	if err = rep.writeIndex(); err != nil {
+		return
 	}
 
 	err = rep.fileWriter.Flush()
 }
 
+func (rep *Replay) writeEntry(entry *visualize_grpc_pb.ReplayEntry) error {
+	data, err := proto.Marshal(entry)
+	if err != nil {
+		return err
+	}
+
+	return rep.writeRecord(recordTypeEntry, data)
+}
+
+func (rep *Replay) writeKeyframe(entries []*visualize_grpc_pb.ReplayEntry) error {
+	rep.index = append(rep.index, keyframeIndexEntry{
+		Timestamp: entries[0].Timestamp,
+		Offset:    rep.offset,
+	})
+
+	var countBuf [4]byte
+	binary.LittleEndian.PutUint32(countBuf[:], uint32(len(entries)))
+	if err := rep.writeRecord(recordTypeKeyframe, countBuf[:]); err != nil {
+		return err
+	}
+
+	for _, entry := range entries {
+		if err := rep.writeEntry(entry); err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+func (rep *Replay) writeRecord(recordType byte, payload []byte) error {
+	var header [recordHeaderSize]byte
+	header[0] = recordType
+	binary.LittleEndian.PutUint32(header[1:], uint32(len(payload)))
+	if err := rep.writeRaw(header[:]); err != nil {
+		return err
+	}
+
+	return rep.writeRaw(payload)
+}
+
+// writeIndex appends the keyframe index footer:
+// [4-byte count][count x (8-byte timestamp, 8-byte offset)][4-byte index
+// length][8-byte index magic].
+func (rep *Replay) writeIndex() error {
+	indexLen := 4 + len(rep.index)*16
+	buf := make([]byte, indexLen+4+len(indexMagic))
+	binary.LittleEndian.PutUint32(buf[:4], uint32(len(rep.index)))
+	pos := 4
+	for _, ent := range rep.index {
+		binary.LittleEndian.PutUint64(buf[pos:], ent.Timestamp)
+		binary.LittleEndian.PutUint64(buf[pos+8:], ent.Offset)
+		pos += 16
+	}
+	binary.LittleEndian.PutUint32(buf[pos:], uint32(indexLen))
+	copy(buf[pos+4:], indexMagic)
+
+	return rep.writeRaw(buf)
+}
+
+func (rep *Replay) writeRaw(data []byte) error {
+	n, err := rep.fileWriter.Write(data)
+	rep.offset += uint64(n)
+	return err
+}
+
 func NewReplay(filename string) *Replay {
 	f, err := os.OpenFile(filename, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
 	simplelogger.PanicIfError(err)
@@ -88,7 +219,7 @@ func NewReplay(filename string) *Replay {
 	rep := &Replay{
 		f:              f,
 		fileWriter:     bufio.NewWriterSize(f, 8192),
-		pendingChan:    make(chan *visualize_grpc_pb.ReplayEntry, 10000),
+		pendingChan:    make(chan replayItem, 10000),
 		fileWriterDone: make(chan struct{}),
 		beginTime:      time.Now(),
 	}
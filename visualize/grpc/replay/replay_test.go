@@ -0,0 +1,95 @@
+package replay
+
+import (
+	"io"
+	"io/ioutil"
+	"math"
+	"os"
+	"path/filepath"
+	"testing"
+
+	visualize_grpc_pb "github.com/openthread/ot-ns/visualize/grpc/pb"
+	"github.com/stretchr/testify/assert"
+)
+
+func addNodeEvent(nodeid int32) *visualize_grpc_pb.VisualizeEvent {
+	return &visualize_grpc_pb.VisualizeEvent{Type: &visualize_grpc_pb.VisualizeEvent_AddNode{AddNode: &visualize_grpc_pb.AddNodeEvent{
+		NodeId: nodeid,
+	}}}
+}
+
+func eventNodeId(event *visualize_grpc_pb.VisualizeEvent) int32 {
+	return event.GetAddNode().NodeId
+}
+
+func TestReplayRoundTrip(t *testing.T) {
+	filename := filepath.Join(os.TempDir(), "test.replay")
+	defer os.Remove(filename)
+
+	rep := NewReplay(filename)
+	rep.Append(addNodeEvent(1), false)
+	rep.Append(addNodeEvent(2), false)
+	rep.AppendKeyframe([]*visualize_grpc_pb.VisualizeEvent{addNodeEvent(1), addNodeEvent(2)})
+	rep.Append(addNodeEvent(3), false)
+	rep.Close()
+
+	assert.True(t, IsBinaryReplay(filename))
+
+	reader, err := NewReader(filename)
+	assert.Nil(t, err)
+	defer reader.Close()
+
+	// linear reading skips the keyframe snapshot
+	var nodeids []int32
+	for {
+		entry, err := reader.ReadEntry()
+		if err == io.EOF {
+			break
+		}
+		assert.Nil(t, err)
+		nodeids = append(nodeids, eventNodeId(entry.Event))
+	}
+	assert.Equal(t, []int32{1, 2, 3}, nodeids)
+
+	// seeking past the keyframe emits the snapshot and the entries after it
+	assert.Nil(t, reader.SeekTimestamp(math.MaxUint64/2))
+	nodeids = nil
+	for {
+		entry, err := reader.ReadEntry()
+		if err == io.EOF {
+			break
+		}
+		assert.Nil(t, err)
+		nodeids = append(nodeids, eventNodeId(entry.Event))
+	}
+	assert.Equal(t, []int32{1, 2, 3}, nodeids)
+
+	// seeking before the first keyframe rewinds to the beginning
+	assert.Nil(t, reader.SeekTimestamp(0))
+	entry, err := reader.ReadEntry()
+	assert.Nil(t, err)
+	assert.Equal(t, int32(1), eventNodeId(entry.Event))
+}
+
+func TestReplayReaderNoFooter(t *testing.T) {
+	filename := filepath.Join(os.TempDir(), "test-nofooter.replay")
+	defer os.Remove(filename)
+
+	rep := NewReplay(filename)
+	rep.Append(addNodeEvent(1), false)
+	rep.Close()
+
+	// drop the footer as if the simulation was aborted
+	data, err := ioutil.ReadFile(filename)
+	assert.Nil(t, err)
+	footerLen := 4 + 4 + len(indexMagic) // empty index + length + magic
+	assert.Nil(t, ioutil.WriteFile(filename, data[:len(data)-footerLen], 0644))
+
+	reader, err := NewReader(filename)
+	assert.Nil(t, err)
+	defer reader.Close()
+
+	entry, err := reader.ReadEntry()
+	assert.Nil(t, err)
+	assert.Equal(t, int32(1), eventNodeId(entry.Event))
+}
@@ -0,0 +1,250 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package visualize_multi
+
+import (
+	"expvar"
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/simonlingoogle/go-simplelogger"
+
+	. "github.com/openthread/ot-ns/types"
+	"github.com/openthread/ot-ns/visualize"
+)
+
+// asyncQueueCapacity is the per-child queue size above which trivial events
+// start being dropped. Non-trivial (state-changing) events are never dropped;
+// they may grow the queue past this capacity, but their rate is bounded by
+// topology churn rather than traffic volume.
+const asyncQueueCapacity = 8192
+
+// visQueueStats exposes per-child drop counters on the expvar endpoint (see
+// the -metrics option) so slow visualization consumers can be diagnosed.
+var visQueueStats = expvar.NewMap("otns_vis_queues")
+
+var nextAsyncVisualizerId int32
+
+type asyncCall struct {
+	fn      func()
+	trivial bool
+}
+
+// asyncVisualizer decouples a child visualizer from the dispatcher: calls are
+// queued and replayed in order on a dedicated goroutine, so a slow consumer
+// (a stalled gRPC client, replay file backpressure) can never throttle the
+// simulation loop. When the queue is full the oldest trivial event (a frame
+// animation or a time advance) is dropped to make room.
+type asyncVisualizer struct {
+	v       visualize.Visualizer
+	dropped *expvar.Int
+	done    chan struct{} // closed when drainLoop exits
+
+	mu      sync.Mutex
+	cond    *sync.Cond
+	queue   []asyncCall
+	running bool
+	stopped bool
+}
+
+func newAsyncVisualizer(v visualize.Visualizer) *asyncVisualizer {
+	av := &asyncVisualizer{
+		v:       v,
+		dropped: new(expvar.Int),
+		done:    make(chan struct{}),
+	}
+	av.cond = sync.NewCond(&av.mu)
+	id := atomic.AddInt32(&nextAsyncVisualizerId, 1)
+	visQueueStats.Set(fmt.Sprintf("child_%d_dropped", id), av.dropped)
+	return av
+}
+
+func (av *asyncVisualizer) enqueue(trivial bool, fn func()) {
+	av.mu.Lock()
+	if av.stopped {
+		av.mu.Unlock()
+		return
+	}
+
+	if len(av.queue) >= asyncQueueCapacity {
+		for i, call := range av.queue {
+			if call.trivial {
+				av.queue = append(av.queue[:i], av.queue[i+1:]...)
+				av.dropped.Add(1)
+				if av.dropped.Value()%10000 == 1 {
+					simplelogger.Warnf("visualization consumer too slow: %d events dropped", av.dropped.Value())
+				}
+				break
+			}
+		}
+	}
+
+	av.queue = append(av.queue, asyncCall{fn: fn, trivial: trivial})
+	av.mu.Unlock()
+	av.cond.Signal()
+}
+
+func (av *asyncVisualizer) drainLoop() {
+	defer close(av.done)
+
+	for {
+		av.mu.Lock()
+		for len(av.queue) == 0 && !av.stopped {
+			av.cond.Wait()
+		}
+		if len(av.queue) == 0 {
+			av.mu.Unlock()
+			return
+		}
+		call := av.queue[0]
+		av.queue[0] = asyncCall{}
+		av.queue = av.queue[1:]
+		av.mu.Unlock()
+
+		call.fn()
+	}
+}
+
+func (av *asyncVisualizer) Run() {
+	av.mu.Lock()
+	av.running = true
+	av.mu.Unlock()
+
+	go av.drainLoop()
+	av.v.Run()
+}
+
+func (av *asyncVisualizer) Stop() {
+	av.mu.Lock()
+	av.stopped = true
+	running := av.running
+	av.mu.Unlock()
+	av.cond.Signal()
+
+	// wait for the drain loop to replay the already queued events before
+	// stopping the child: stopping it earlier could close resources (such as
+	// the gRPC child's replay writer) that queued events still deliver into
+	if running {
+		<-av.done
+	}
+
+	av.v.Stop()
+}
+
+func (av *asyncVisualizer) SetController(ctrl visualize.SimulationController) {
+	av.v.SetController(ctrl)
+}
+
+func (av *asyncVisualizer) AddNode(nodeid NodeId, x int, y int, radioRange int) {
+	av.enqueue(false, func() { av.v.AddNode(nodeid, x, y, radioRange) })
+}
+
+func (av *asyncVisualizer) SetNodeRloc16(nodeid NodeId, rloc16 uint16) {
+	av.enqueue(false, func() { av.v.SetNodeRloc16(nodeid, rloc16) })
+}
+
+func (av *asyncVisualizer) SetNodeRole(nodeid NodeId, role OtDeviceRole) {
+	av.enqueue(false, func() { av.v.SetNodeRole(nodeid, role) })
+}
+
+func (av *asyncVisualizer) SetNodeMode(nodeid NodeId, mode NodeMode) {
+	av.enqueue(false, func() { av.v.SetNodeMode(nodeid, mode) })
+}
+
+func (av *asyncVisualizer) Send(srcid NodeId, dstid NodeId, mvinfo *visualize.MsgVisualizeInfo) {
+	av.enqueue(true, func() { av.v.Send(srcid, dstid, mvinfo) })
+}
+
+func (av *asyncVisualizer) SetNodePartitionId(nodeid NodeId, parid uint32) {
+	av.enqueue(false, func() { av.v.SetNodePartitionId(nodeid, parid) })
+}
+
+func (av *asyncVisualizer) SetSpeed(speed float64) {
+	av.enqueue(false, func() { av.v.SetSpeed(speed) })
+}
+
+func (av *asyncVisualizer) AdvanceTime(ts uint64, speed float64) {
+	av.enqueue(true, func() { av.v.AdvanceTime(ts, speed) })
+}
+
+func (av *asyncVisualizer) OnNodeFail(nodeid NodeId) {
+	av.enqueue(false, func() { av.v.OnNodeFail(nodeid) })
+}
+
+func (av *asyncVisualizer) OnNodeRecover(nodeid NodeId) {
+	av.enqueue(false, func() { av.v.OnNodeRecover(nodeid) })
+}
+
+func (av *asyncVisualizer) SetNodePos(nodeid NodeId, x, y int) {
+	av.enqueue(false, func() { av.v.SetNodePos(nodeid, x, y) })
+}
+
+func (av *asyncVisualizer) DeleteNode(id NodeId) {
+	av.enqueue(false, func() { av.v.DeleteNode(id) })
+}
+
+func (av *asyncVisualizer) AddRouterTable(id NodeId, extaddr uint64) {
+	av.enqueue(false, func() { av.v.AddRouterTable(id, extaddr) })
+}
+
+func (av *asyncVisualizer) RemoveRouterTable(id NodeId, extaddr uint64) {
+	av.enqueue(false, func() { av.v.RemoveRouterTable(id, extaddr) })
+}
+
+func (av *asyncVisualizer) AddChildTable(id NodeId, extaddr uint64) {
+	av.enqueue(false, func() { av.v.AddChildTable(id, extaddr) })
+}
+
+func (av *asyncVisualizer) RemoveChildTable(id NodeId, extaddr uint64) {
+	av.enqueue(false, func() { av.v.RemoveChildTable(id, extaddr) })
+}
+
+func (av *asyncVisualizer) ShowDemoLegend(x int, y int, title string) {
+	av.enqueue(false, func() { av.v.ShowDemoLegend(x, y, title) })
+}
+
+func (av *asyncVisualizer) CountDown(duration time.Duration, text string) {
+	av.enqueue(false, func() { av.v.CountDown(duration, text) })
+}
+
+func (av *asyncVisualizer) SetParent(id NodeId, extaddr uint64) {
+	av.enqueue(false, func() { av.v.SetParent(id, extaddr) })
+}
+
+func (av *asyncVisualizer) OnExtAddrChange(id NodeId, extaddr uint64) {
+	av.enqueue(false, func() { av.v.OnExtAddrChange(id, extaddr) })
+}
+
+func (av *asyncVisualizer) SetTitle(titleInfo visualize.TitleInfo) {
+	av.enqueue(false, func() { av.v.SetTitle(titleInfo) })
+}
+
+func (av *asyncVisualizer) SetNetworkInfo(networkInfo visualize.NetworkInfo) {
+	av.enqueue(false, func() { av.v.SetNetworkInfo(networkInfo) })
+}
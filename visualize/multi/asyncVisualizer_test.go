@@ -0,0 +1,117 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package visualize_multi
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+
+	"github.com/openthread/ot-ns/visualize"
+)
+
+func TestAsyncVisualizer_DrainsInOrder(t *testing.T) {
+	av := newAsyncVisualizer(nil)
+
+	var got []int
+	done := make(chan struct{})
+	for i := 0; i < 100; i++ {
+		i := i
+		av.enqueue(i%2 == 0, func() {
+			got = append(got, i)
+			if i == 99 {
+				close(done)
+			}
+		})
+	}
+
+	go av.drainLoop()
+	select {
+	case <-done:
+	case <-time.After(time.Second):
+		t.Fatal("queue not drained")
+	}
+
+	assert.Equal(t, 100, len(got))
+	for i, v := range got {
+		assert.Equal(t, i, v)
+	}
+
+	av.mu.Lock()
+	av.stopped = true
+	av.mu.Unlock()
+	av.cond.Signal()
+}
+
+func TestAsyncVisualizer_StopDrainsQueue(t *testing.T) {
+	av := newAsyncVisualizer(visualize.NewNopVisualizer())
+	go av.Run()
+	for {
+		av.mu.Lock()
+		running := av.running
+		av.mu.Unlock()
+		if running {
+			break
+		}
+		time.Sleep(time.Millisecond)
+	}
+
+	ran := 0
+	for i := 0; i < 1000; i++ {
+		av.enqueue(false, func() { ran++ })
+	}
+
+	// Stop must replay everything still queued before stopping the child
+	av.Stop()
+	assert.Equal(t, 1000, ran)
+}
+
+func TestAsyncVisualizer_DropOldestTrivial(t *testing.T) {
+	// the drain loop is intentionally not running, so the queue fills up
+	av := newAsyncVisualizer(nil)
+
+	for i := 0; i < asyncQueueCapacity; i++ {
+		av.enqueue(true, func() {})
+	}
+	av.enqueue(false, func() {})
+
+	av.mu.Lock()
+	assert.Equal(t, asyncQueueCapacity, len(av.queue))
+	assert.False(t, av.queue[len(av.queue)-1].trivial)
+	av.mu.Unlock()
+	assert.Equal(t, int64(1), av.dropped.Value())
+
+	// a full queue of non-trivial events grows instead of dropping
+	for i := 0; i < asyncQueueCapacity; i++ {
+		av.enqueue(false, func() {})
+	}
+	av.mu.Lock()
+	assert.True(t, len(av.queue) > asyncQueueCapacity)
+	av.mu.Unlock()
+	assert.Equal(t, int64(asyncQueueCapacity), av.dropped.Value())
+}
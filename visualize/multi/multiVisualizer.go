@@ -190,5 +190,11 @@ func (mv *multiVisualizer) SetTitle(titleInfo visualize.TitleInfo) {
 }
 
 func NewMultiVisualizer(vs ...visualize.Visualizer) visualize.Visualizer {
-	return &multiVisualizer{vs: vs}
+	// every child is decoupled behind its own queue so that one slow
+	// consumer can not stall the dispatcher through visSend
+	avs := make([]visualize.Visualizer, len(vs))
+	for i, v := range vs {
+		avs[i] = newAsyncVisualizer(v)
+	}
+	return &multiVisualizer{vs: avs}
 }
@@ -0,0 +1,373 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package visualize_ws
+
+import (
+	"bufio"
+	"crypto/sha1"
+	"encoding/base64"
+	"encoding/binary"
+	"io"
+	"net"
+	"net/http"
+	"strings"
+	"sync"
+
+	"github.com/simonlingoogle/go-simplelogger"
+)
+
+// wsSubProtocol names the binary delta format; clients must request it during
+// the WebSocket handshake so that the format can evolve without breaking
+// older clients.
+const wsSubProtocol = "otns-delta.v1"
+
+// wsGUID is the fixed key-derivation constant of RFC 6455.
+const wsGUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+// WebSocket opcodes
+const (
+	wsOpBinary = 0x2
+	wsOpClose  = 0x8
+	wsOpPing   = 0x9
+	wsOpPong   = 0xa
+)
+
+// clientSendBufSize is the per-client frame queue; a client that cannot keep
+// up with the delta cadence is disconnected and will resynchronize with a
+// fresh snapshot when it reconnects.
+const clientSendBufSize = 64
+
+type wsMessage struct {
+	opcode  byte
+	payload []byte
+}
+
+type wsClient struct {
+	conn      net.Conn
+	out       chan wsMessage
+	closeOnce sync.Once
+}
+
+func (c *wsClient) close() {
+	c.closeOnce.Do(func() {
+		close(c.out)
+	})
+}
+
+// wsServer is a minimal server-to-client WebSocket implementation (RFC 6455)
+// on top of net/http. It only needs the handshake, server-side binary data
+// frames and the Ping/Close control frames, so it avoids pulling in a full
+// WebSocket dependency.
+type wsServer struct {
+	vis  *wsVisualizer
+	addr string
+
+	mu      sync.Mutex
+	clients map[*wsClient]struct{}
+	lis     net.Listener
+	stopped bool
+}
+
+func newWsServer(vis *wsVisualizer, addr string) *wsServer {
+	return &wsServer{
+		vis:     vis,
+		addr:    addr,
+		clients: map[*wsClient]struct{}{},
+	}
+}
+
+func (s *wsServer) Run() error {
+	lis, err := net.Listen("tcp", s.addr)
+	if err != nil {
+		return err
+	}
+
+	s.mu.Lock()
+	if s.stopped {
+		s.mu.Unlock()
+		_ = lis.Close()
+		return nil
+	}
+	s.lis = lis
+	s.mu.Unlock()
+
+	simplelogger.Infof("websocket visualization server serving on %s ...", s.addr)
+	err = (&http.Server{Handler: s}).Serve(lis)
+
+	s.mu.Lock()
+	stopped := s.stopped
+	s.mu.Unlock()
+	if stopped {
+		return nil
+	}
+	return err
+}
+
+func (s *wsServer) stop() {
+	s.mu.Lock()
+	s.stopped = true
+	lis := s.lis
+	clients := make([]*wsClient, 0, len(s.clients))
+	for c := range s.clients {
+		clients = append(clients, c)
+	}
+	s.clients = map[*wsClient]struct{}{}
+	s.mu.Unlock()
+
+	if lis != nil {
+		_ = lis.Close()
+	}
+	for _, c := range clients {
+		c.close()
+	}
+}
+
+func (s *wsServer) clientCount() int {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return len(s.clients)
+}
+
+// broadcast queues frame to all connected clients; slow clients are dropped.
+func (s *wsServer) broadcast(frame []byte) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	for c := range s.clients {
+		select {
+		case c.out <- wsMessage{opcode: wsOpBinary, payload: frame}:
+		default:
+			simplelogger.Warnf("websocket client %v too slow, dropping", c.conn.RemoteAddr())
+			delete(s.clients, c)
+			c.close()
+		}
+	}
+}
+
+// closeClient unregisters the client before closing its send channel, so
+// broadcast (which sends while holding the lock) can never hit a closed
+// channel.
+func (s *wsServer) closeClient(c *wsClient) {
+	s.mu.Lock()
+	delete(s.clients, c)
+	s.mu.Unlock()
+	c.close()
+}
+
+func (s *wsServer) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	if !strings.EqualFold(r.Header.Get("Upgrade"), "websocket") {
+		http.Error(w, "websocket upgrade required", http.StatusBadRequest)
+		return
+	}
+	key := r.Header.Get("Sec-WebSocket-Key")
+	if key == "" {
+		http.Error(w, "missing Sec-WebSocket-Key", http.StatusBadRequest)
+		return
+	}
+	if !offersSubProtocol(r.Header.Values("Sec-WebSocket-Protocol")) {
+		http.Error(w, "subprotocol "+wsSubProtocol+" required", http.StatusBadRequest)
+		return
+	}
+
+	hj, ok := w.(http.Hijacker)
+	if !ok {
+		http.Error(w, "connection cannot be hijacked", http.StatusInternalServerError)
+		return
+	}
+	conn, brw, err := hj.Hijack()
+	if err != nil {
+		simplelogger.Errorf("websocket hijack failed: %v", err)
+		return
+	}
+
+	sum := sha1.Sum([]byte(key + wsGUID))
+	accept := base64.StdEncoding.EncodeToString(sum[:])
+	response := "HTTP/1.1 101 Switching Protocols\r\n" +
+		"Upgrade: websocket\r\n" +
+		"Connection: Upgrade\r\n" +
+		"Sec-WebSocket-Accept: " + accept + "\r\n" +
+		"Sec-WebSocket-Protocol: " + wsSubProtocol + "\r\n\r\n"
+	if _, err = brw.WriteString(response); err == nil {
+		err = brw.Flush()
+	}
+	if err != nil {
+		_ = conn.Close()
+		return
+	}
+
+	s.serveClient(conn, brw.Reader)
+}
+
+func offersSubProtocol(headers []string) bool {
+	for _, h := range headers {
+		for _, p := range strings.Split(h, ",") {
+			if strings.TrimSpace(p) == wsSubProtocol {
+				return true
+			}
+		}
+	}
+	return false
+}
+
+func (s *wsServer) serveClient(conn net.Conn, br *bufio.Reader) {
+	client := &wsClient{
+		conn: conn,
+		out:  make(chan wsMessage, clientSendBufSize),
+	}
+
+	// the snapshot is queued before the client is registered for broadcasts,
+	// so it is guaranteed to precede any delta the client receives
+	client.out <- wsMessage{opcode: wsOpBinary, payload: s.vis.takeSnapshot()}
+
+	s.mu.Lock()
+	if s.stopped {
+		s.mu.Unlock()
+		_ = conn.Close()
+		return
+	}
+	s.clients[client] = struct{}{}
+	s.mu.Unlock()
+
+	simplelogger.Infof("websocket client %v connected", conn.RemoteAddr())
+	go s.writeLoop(client)
+	go s.readLoop(client, br)
+}
+
+func (s *wsServer) writeLoop(c *wsClient) {
+	for msg := range c.out {
+		if err := writeWsFrame(c.conn, msg.opcode, msg.payload); err != nil {
+			break
+		}
+	}
+
+	s.closeClient(c)
+	_ = c.conn.Close()
+}
+
+// readLoop consumes client frames; only Close and Ping are acted upon, data
+// frames from the client are discarded (the protocol is server push only).
+func (s *wsServer) readLoop(c *wsClient, br *bufio.Reader) {
+	defer s.closeClient(c)
+
+	for {
+		opcode, payload, err := readWsFrame(br)
+		if err != nil {
+			return
+		}
+
+		switch opcode {
+		case wsOpClose:
+			s.trySend(c, wsMessage{opcode: wsOpClose, payload: payload})
+			return
+		case wsOpPing:
+			s.trySend(c, wsMessage{opcode: wsOpPong, payload: payload})
+		}
+	}
+}
+
+func (s *wsServer) trySend(c *wsClient, msg wsMessage) {
+	defer func() {
+		// the out channel may be closed concurrently by close()
+		_ = recover()
+	}()
+	select {
+	case c.out <- msg:
+	default:
+	}
+}
+
+// writeWsFrame writes one unmasked (server-to-client) frame.
+func writeWsFrame(w io.Writer, opcode byte, payload []byte) error {
+	hdr := make([]byte, 2, 10)
+	hdr[0] = 0x80 | opcode // FIN + opcode
+	n := len(payload)
+	switch {
+	case n < 126:
+		hdr[1] = byte(n)
+	case n < 65536:
+		hdr[1] = 126
+		hdr = append(hdr, byte(n>>8), byte(n))
+	default:
+		hdr[1] = 127
+		hdr = hdr[:10]
+		binary.BigEndian.PutUint64(hdr[2:], uint64(n))
+	}
+
+	if _, err := w.Write(hdr); err != nil {
+		return err
+	}
+	_, err := w.Write(payload)
+	return err
+}
+
+// maxClientFrameSize bounds client frames; clients only ever send small
+// control frames, so anything larger indicates a broken peer.
+const maxClientFrameSize = 4096
+
+// readWsFrame reads one masked (client-to-server) frame and unmasks its
+// payload.
+func readWsFrame(br *bufio.Reader) (opcode byte, payload []byte, err error) {
+	var hdr [2]byte
+	if _, err = io.ReadFull(br, hdr[:]); err != nil {
+		return
+	}
+
+	opcode = hdr[0] & 0x0f
+	masked := hdr[1]&0x80 != 0
+	length := uint64(hdr[1] & 0x7f)
+	if length == 126 {
+		var ext [2]byte
+		if _, err = io.ReadFull(br, ext[:]); err != nil {
+			return
+		}
+		length = uint64(binary.BigEndian.Uint16(ext[:]))
+	} else if length == 127 {
+		var ext [8]byte
+		if _, err = io.ReadFull(br, ext[:]); err != nil {
+			return
+		}
+		length = binary.BigEndian.Uint64(ext[:])
+	}
+	if !masked || length > maxClientFrameSize {
+		err = io.ErrUnexpectedEOF
+		return
+	}
+
+	var mask [4]byte
+	if _, err = io.ReadFull(br, mask[:]); err != nil {
+		return
+	}
+
+	payload = make([]byte, length)
+	if _, err = io.ReadFull(br, payload); err != nil {
+		return
+	}
+	for i := range payload {
+		payload[i] ^= mask[i&3]
+	}
+	return
+}
@@ -0,0 +1,466 @@
+// Copyright (c) 2020, The OTNS Authors.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the copyright holder nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package visualize_ws
+
+import (
+	"encoding/binary"
+	"math"
+	"sync"
+	"time"
+
+	"github.com/simonlingoogle/go-simplelogger"
+
+	. "github.com/openthread/ot-ns/types"
+	"github.com/openthread/ot-ns/visualize"
+)
+
+// deltaInterval is the cadence of the binary delta frames; all state changes
+// within one interval are coalesced into a single frame per client.
+const deltaInterval = 100 * time.Millisecond
+
+// binary frame types (first byte of every frame)
+const (
+	frameSnapshot = 0
+	frameDelta    = 1
+)
+
+// flags of a node record within a frame
+const (
+	nodeFlagFailed  = 1 << 0
+	nodeFlagDeleted = 1 << 1
+)
+
+type linkKind uint8
+
+const (
+	linkRouter linkKind = iota
+	linkChild
+	linkParent
+)
+
+type wsNode struct {
+	x, y        int
+	role        OtDeviceRole
+	partitionId uint32
+	rloc16      uint16
+	failed      bool
+}
+
+// wsLink keeps the peer as the raw extended address as reported by the node;
+// it is resolved to a node id when the link is encoded into a frame.
+type wsLink struct {
+	id      NodeId
+	extaddr uint64
+	kind    linkKind
+}
+
+// wsVisualizer mirrors the aggregate node & link state of the simulation and
+// periodically pushes compact binary deltas to WebSocket clients. Unlike the
+// gRPC visualizer it does not forward individual events: per-message
+// animations (Send) and decorations stay on the gRPC stream, so the delta
+// channel stays O(changed state) per interval regardless of traffic volume.
+type wsVisualizer struct {
+	server *wsServer
+	done   chan struct{}
+
+	sync.Mutex
+	simctrl      visualize.SimulationController
+	nodes        map[NodeId]*wsNode
+	extaddrMap   map[uint64]NodeId
+	links        map[wsLink]struct{}
+	dirtyNodes   map[NodeId]struct{}
+	deletedNodes map[NodeId]struct{}
+	addedLinks   map[wsLink]struct{}
+	removedLinks map[wsLink]struct{}
+	curTime      uint64
+	curSpeed     float64
+}
+
+// NewWsVisualizer creates a visualizer that serves binary state deltas over
+// WebSocket on the given listen address.
+func NewWsVisualizer(addr string) visualize.Visualizer {
+	wv := &wsVisualizer{
+		done:         make(chan struct{}),
+		nodes:        map[NodeId]*wsNode{},
+		extaddrMap:   map[uint64]NodeId{},
+		links:        map[wsLink]struct{}{},
+		dirtyNodes:   map[NodeId]struct{}{},
+		deletedNodes: map[NodeId]struct{}{},
+		addedLinks:   map[wsLink]struct{}{},
+		removedLinks: map[wsLink]struct{}{},
+	}
+	wv.server = newWsServer(wv, addr)
+	return wv
+}
+
+func (wv *wsVisualizer) Run() {
+	go wv.deltaLoop()
+
+	err := wv.server.Run()
+	if err != nil {
+		simplelogger.Errorf("websocket server quited: %v", err)
+	}
+}
+
+func (wv *wsVisualizer) Stop() {
+	close(wv.done)
+	wv.server.stop()
+}
+
+func (wv *wsVisualizer) deltaLoop() {
+	ticker := time.NewTicker(deltaInterval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-wv.done:
+			return
+		case <-ticker.C:
+			if wv.server.clientCount() == 0 {
+				continue
+			}
+			// frames are sent even when no state changed so that clients can
+			// keep interpolating against the advancing simulation time
+			wv.server.broadcast(wv.takeDelta())
+		}
+	}
+}
+
+// takeDelta encodes all changes since the previous call into one delta frame
+// and resets the dirty sets.
+func (wv *wsVisualizer) takeDelta() []byte {
+	wv.Lock()
+	defer wv.Unlock()
+
+	frame := wv.encodeFrame(frameDelta, wv.dirtyNodes, wv.deletedNodes, wv.addedLinks, wv.removedLinks)
+
+	if len(wv.dirtyNodes) > 0 {
+		wv.dirtyNodes = map[NodeId]struct{}{}
+	}
+	if len(wv.deletedNodes) > 0 {
+		wv.deletedNodes = map[NodeId]struct{}{}
+	}
+	if len(wv.addedLinks) > 0 {
+		wv.addedLinks = map[wsLink]struct{}{}
+	}
+	if len(wv.removedLinks) > 0 {
+		wv.removedLinks = map[wsLink]struct{}{}
+	}
+
+	return frame
+}
+
+// takeSnapshot encodes the full current state; sent once to every new client
+// before it receives deltas.
+func (wv *wsVisualizer) takeSnapshot() []byte {
+	wv.Lock()
+	defer wv.Unlock()
+
+	allNodes := make(map[NodeId]struct{}, len(wv.nodes))
+	for id := range wv.nodes {
+		allNodes[id] = struct{}{}
+	}
+
+	return wv.encodeFrame(frameSnapshot, allNodes, nil, wv.links, nil)
+}
+
+// encodeFrame serializes one frame. The layout is little-endian and uses
+// fixed-size records so that the browser can wrap the sections in typed
+// arrays without a per-field parser:
+//
+//	u8 frame type, u8[3] reserved, u64 timestamp (us), f64 speed
+//	u32 node count, node records (20 bytes each):
+//	    u32 id, i32 x, i32 y, u8 role, u8 flags, u16 rloc16, u32 partition
+//	u32 added link count, link records (12 bytes each):
+//	    u32 src id, u32 dst id, u8 kind, u8[3] reserved
+//	u32 removed link count, link records as above
+func (wv *wsVisualizer) encodeFrame(frameType byte, nodes map[NodeId]struct{}, deleted map[NodeId]struct{},
+	addedLinks map[wsLink]struct{}, removedLinks map[wsLink]struct{}) []byte {
+	buf := make([]byte, 0, 20+20*(len(nodes)+len(deleted))+12*(len(addedLinks)+len(removedLinks))+12)
+	buf = append(buf, frameType, 0, 0, 0)
+	buf = appendUint64(buf, wv.curTime)
+	buf = appendUint64(buf, math.Float64bits(wv.curSpeed))
+
+	buf = appendUint32(buf, uint32(len(nodes)+len(deleted)))
+	for id := range nodes {
+		node := wv.nodes[id]
+		buf = appendUint32(buf, uint32(id))
+		buf = appendUint32(buf, uint32(int32(node.x)))
+		buf = appendUint32(buf, uint32(int32(node.y)))
+		flags := byte(0)
+		if node.failed {
+			flags |= nodeFlagFailed
+		}
+		buf = append(buf, byte(node.role), flags)
+		buf = appendUint16(buf, node.rloc16)
+		buf = appendUint32(buf, node.partitionId)
+	}
+	for id := range deleted {
+		buf = appendUint32(buf, uint32(id))
+		buf = append(buf, 0, 0, 0, 0, 0, 0, 0, 0) // x, y
+		buf = append(buf, 0, nodeFlagDeleted)
+		buf = append(buf, 0, 0, 0, 0, 0, 0) // rloc16, partition
+	}
+
+	buf = wv.encodeLinks(buf, addedLinks)
+	buf = wv.encodeLinks(buf, removedLinks)
+	return buf
+}
+
+func (wv *wsVisualizer) encodeLinks(buf []byte, links map[wsLink]struct{}) []byte {
+	countPos := len(buf)
+	buf = appendUint32(buf, 0)
+
+	count := uint32(0)
+	for l := range links {
+		// links whose peer extaddr is not announced yet are re-marked dirty
+		// by OnExtAddrChange once it is, so skipping them here is lossless
+		peer, ok := wv.extaddrMap[l.extaddr]
+		if !ok {
+			continue
+		}
+		buf = appendUint32(buf, uint32(l.id))
+		buf = appendUint32(buf, uint32(peer))
+		buf = append(buf, byte(l.kind), 0, 0, 0)
+		count++
+	}
+
+	binary.LittleEndian.PutUint32(buf[countPos:], count)
+	return buf
+}
+
+func appendUint16(buf []byte, v uint16) []byte {
+	return append(buf, byte(v), byte(v>>8))
+}
+
+func appendUint32(buf []byte, v uint32) []byte {
+	return append(buf, byte(v), byte(v>>8), byte(v>>16), byte(v>>24))
+}
+
+func appendUint64(buf []byte, v uint64) []byte {
+	return append(buf, byte(v), byte(v>>8), byte(v>>16), byte(v>>24),
+		byte(v>>32), byte(v>>40), byte(v>>48), byte(v>>56))
+}
+
+func (wv *wsVisualizer) AddNode(nodeid NodeId, x int, y int, radioRange int) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	wv.nodes[nodeid] = &wsNode{x: x, y: y}
+	wv.dirtyNodes[nodeid] = struct{}{}
+	delete(wv.deletedNodes, nodeid)
+}
+
+func (wv *wsVisualizer) DeleteNode(id NodeId) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	node := wv.nodes[id]
+	if node == nil {
+		return
+	}
+
+	delete(wv.nodes, id)
+	delete(wv.dirtyNodes, id)
+	wv.deletedNodes[id] = struct{}{}
+
+	for extaddr, owner := range wv.extaddrMap {
+		if owner == id {
+			delete(wv.extaddrMap, extaddr)
+		}
+	}
+	for l := range wv.links {
+		if l.id == id {
+			wv.removeLink(l)
+		}
+	}
+}
+
+func (wv *wsVisualizer) SetNodePos(nodeid NodeId, x, y int) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	if node := wv.nodes[nodeid]; node != nil {
+		node.x, node.y = x, y
+		wv.dirtyNodes[nodeid] = struct{}{}
+	}
+}
+
+func (wv *wsVisualizer) SetNodeRloc16(nodeid NodeId, rloc16 uint16) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	if node := wv.nodes[nodeid]; node != nil {
+		node.rloc16 = rloc16
+		wv.dirtyNodes[nodeid] = struct{}{}
+	}
+}
+
+func (wv *wsVisualizer) SetNodeRole(nodeid NodeId, role OtDeviceRole) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	if node := wv.nodes[nodeid]; node != nil {
+		node.role = role
+		wv.dirtyNodes[nodeid] = struct{}{}
+	}
+}
+
+func (wv *wsVisualizer) SetNodePartitionId(nodeid NodeId, parid uint32) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	if node := wv.nodes[nodeid]; node != nil {
+		node.partitionId = parid
+		wv.dirtyNodes[nodeid] = struct{}{}
+	}
+}
+
+func (wv *wsVisualizer) OnNodeFail(nodeid NodeId) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	if node := wv.nodes[nodeid]; node != nil {
+		node.failed = true
+		wv.dirtyNodes[nodeid] = struct{}{}
+	}
+}
+
+func (wv *wsVisualizer) OnNodeRecover(nodeid NodeId) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	if node := wv.nodes[nodeid]; node != nil {
+		node.failed = false
+		wv.dirtyNodes[nodeid] = struct{}{}
+	}
+}
+
+func (wv *wsVisualizer) OnExtAddrChange(id NodeId, extaddr uint64) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	for old, owner := range wv.extaddrMap {
+		if owner == id {
+			delete(wv.extaddrMap, old)
+		}
+	}
+	wv.extaddrMap[extaddr] = id
+
+	// links recorded before the extaddr was known become encodable now
+	for l := range wv.links {
+		if l.extaddr == extaddr {
+			wv.addedLinks[l] = struct{}{}
+		}
+	}
+}
+
+func (wv *wsVisualizer) AddRouterTable(id NodeId, extaddr uint64) {
+	wv.addLink(wsLink{id: id, extaddr: extaddr, kind: linkRouter})
+}
+
+func (wv *wsVisualizer) RemoveRouterTable(id NodeId, extaddr uint64) {
+	wv.Lock()
+	defer wv.Unlock()
+	wv.removeLink(wsLink{id: id, extaddr: extaddr, kind: linkRouter})
+}
+
+func (wv *wsVisualizer) AddChildTable(id NodeId, extaddr uint64) {
+	wv.addLink(wsLink{id: id, extaddr: extaddr, kind: linkChild})
+}
+
+func (wv *wsVisualizer) RemoveChildTable(id NodeId, extaddr uint64) {
+	wv.Lock()
+	defer wv.Unlock()
+	wv.removeLink(wsLink{id: id, extaddr: extaddr, kind: linkChild})
+}
+
+func (wv *wsVisualizer) SetParent(id NodeId, extaddr uint64) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	// a node has at most one parent link; replace any previous one
+	for l := range wv.links {
+		if l.id == id && l.kind == linkParent && l.extaddr != extaddr {
+			wv.removeLink(l)
+		}
+	}
+	wv.links[wsLink{id: id, extaddr: extaddr, kind: linkParent}] = struct{}{}
+	wv.addedLinks[wsLink{id: id, extaddr: extaddr, kind: linkParent}] = struct{}{}
+}
+
+func (wv *wsVisualizer) addLink(l wsLink) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	wv.links[l] = struct{}{}
+	wv.addedLinks[l] = struct{}{}
+	delete(wv.removedLinks, l)
+}
+
+// removeLink must be called with the lock held.
+func (wv *wsVisualizer) removeLink(l wsLink) {
+	if _, ok := wv.links[l]; !ok {
+		return
+	}
+	delete(wv.links, l)
+	delete(wv.addedLinks, l)
+	wv.removedLinks[l] = struct{}{}
+}
+
+func (wv *wsVisualizer) AdvanceTime(ts uint64, speed float64) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	wv.curTime = ts
+	wv.curSpeed = speed
+}
+
+func (wv *wsVisualizer) SetSpeed(speed float64) {
+	wv.Lock()
+	defer wv.Unlock()
+
+	wv.curSpeed = speed
+}
+
+func (wv *wsVisualizer) SetController(ctrl visualize.SimulationController) {
+	wv.simctrl = ctrl
+}
+
+// Per-message animations and decorations are not part of the aggregate state
+// and stay on the gRPC event stream.
+func (wv *wsVisualizer) Send(srcid NodeId, dstid NodeId, mvinfo *visualize.MsgVisualizeInfo) {}
+
+func (wv *wsVisualizer) SetNodeMode(nodeid NodeId, mode NodeMode) {}
+
+func (wv *wsVisualizer) ShowDemoLegend(x int, y int, title string) {}
+
+func (wv *wsVisualizer) CountDown(duration time.Duration, text string) {}
+
+func (wv *wsVisualizer) SetTitle(titleInfo visualize.TitleInfo) {}
+
+func (wv *wsVisualizer) SetNetworkInfo(networkInfo visualize.NetworkInfo) {}